@@ -2,11 +2,29 @@
 
 #pragma once
 
+#include <locks/anderson.hpp>
 #include <locks/clh-bo.hpp>
+#include <locks/clh-rc-bo.hpp>
+#include <locks/clh-rc.hpp>
 #include <locks/clh.hpp>
+#include <locks/cohort.hpp>
+#include <locks/delegation.hpp>
+#include <locks/flat-combining.hpp>
+#include <locks/instrumented.hpp>
 #include <locks/mcs-bo.hpp>
+#include <locks/mcs-rw.hpp>
 #include <locks/mcs.hpp>
+#include <locks/node-lock.hpp>
+#include <locks/parking.hpp>
+#include <locks/partitioned-ticket-bo.hpp>
+#include <locks/partitioned-ticket.hpp>
+#include <locks/phase-fair-rw.hpp>
+#include <locks/policies.hpp>
+#include <locks/striped.hpp>
 #include <locks/tas-bo.hpp>
 #include <locks/tas.hpp>
+#include <locks/ticket-bo.hpp>
+#include <locks/ticket.hpp>
+#include <locks/traced.hpp>
 #include <locks/ttas-bo.hpp>
 #include <locks/ttas.hpp>
@@ -0,0 +1,133 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace locks {
+
+    // Anderson's array-based queue lock. Every waiter polls its own flag on
+    // its own cache line. The flags are allocated once by the constructor,
+    // acquiring the lock never allocates or looks up a node.
+    //
+    // The ring needs a slot for every thread that may wait for the lock at
+    // the same time, otherwise two waiters share a slot and both enter. With
+    // a spinning wait policy that is the number of worker threads, which the
+    // default constructor sizes it for; wait policies that let the scheduler
+    // run other tasks while waiting need room for every task that may
+    // contend. The ring has at least Slots slots and is rounded up to a power
+    // of two.
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact, std::size_t Slots = 128>
+    class basic_Anderson_lock
+    {
+        static_assert(Slots != 0 && (Slots & (Slots - 1)) == 0,
+            "the number of slots must be a power of two");
+
+    public:
+        basic_Anderson_lock()
+          : basic_Anderson_lock(platform::thread_count())
+        {
+        }
+
+        explicit basic_Anderson_lock(std::size_t max_waiters);
+
+        LOCKS_NON_COPYABLE(basic_Anderson_lock);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+    private:
+        using slot_index = std::uint32_t;
+
+        struct alignas(policy::cache_line_size) slot
+        {
+            std::atomic<bool> has_lock{false};
+        };
+
+        static std::size_t ring_size(std::size_t max_waiters);
+
+        // Tickets wrap around at 2^32, a power of two, so the ring position
+        // of consecutive tickets stays consecutive
+        slot_index const mask;
+        std::unique_ptr<slot[]> const slots;
+
+        alignas(policy::layout_alignment_v<LayoutPolicy,
+            std::atomic<slot_index>>) std::atomic<slot_index> next_slot{0};
+
+        // Only ever touched by the current lock holder
+        slot_index owner_slot{0};
+    };
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline std::size_t
+    basic_Anderson_lock<WaitPolicy, LayoutPolicy, Slots>::ring_size(
+        std::size_t max_waiters)
+    {
+        std::size_t size = Slots;
+        while (size < max_waiters)
+            size *= 2;
+        return size;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline basic_Anderson_lock<WaitPolicy, LayoutPolicy,
+        Slots>::basic_Anderson_lock(std::size_t max_waiters)
+      : mask(static_cast<slot_index>(ring_size(max_waiters) - 1))
+      , slots(new slot[ring_size(max_waiters)])
+    {
+        slots[0].has_lock.store(true, std::memory_order_relaxed);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline void basic_Anderson_lock<WaitPolicy, LayoutPolicy, Slots>::lock()
+    {
+        slot_index const index =
+            next_slot.fetch_add(1, std::memory_order_relaxed) & mask;
+        std::atomic<bool>& has_lock = slots[index].has_lock;
+
+        WaitPolicy::wait_while(
+            [&has_lock] { return !has_lock.load(std::memory_order_acquire); },
+            "locks::Anderson_lock::lock");
+
+        // Reset the slot for whoever wraps around to it next
+        has_lock.store(false, std::memory_order_relaxed);
+        owner_slot = index;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline bool basic_Anderson_lock<WaitPolicy, LayoutPolicy, Slots>::try_lock()
+    {
+        // Take the next slot only if the lock has already been passed to it
+        slot_index ticket = next_slot.load(std::memory_order_relaxed);
+        std::atomic<bool>& has_lock = slots[ticket & mask].has_lock;
+
+        if (!has_lock.load(std::memory_order_acquire) ||
+            !next_slot.compare_exchange_strong(ticket, ticket + 1,
+                std::memory_order_relaxed, std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        has_lock.store(false, std::memory_order_relaxed);
+        owner_slot = ticket & mask;
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline void basic_Anderson_lock<WaitPolicy, LayoutPolicy, Slots>::unlock()
+    {
+        slots[(owner_slot + 1) & mask].has_lock.store(
+            true, std::memory_order_release);
+    }
+
+    using Anderson_lock = basic_Anderson_lock<policy::pause>;
+
+}    // namespace locks
@@ -0,0 +1,11 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/clh-rc.hpp>
+
+namespace locks {
+
+    using CLH_RC_BO_lock = basic_CLH_RC_lock<policy::yield>;
+
+}    // namespace locks
@@ -0,0 +1,115 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/clh.hpp>
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+#include <util/node_cache.hpp>
+
+#include <atomic>
+#include <chrono>
+
+namespace locks {
+
+    // CLH lock that recycles the predecessor's node for the next acquire, as
+    // in the original algorithm, so that steady-state lock/unlock does no
+    // heap allocation.
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact>
+    class basic_CLH_RC_lock
+    {
+    private:
+        using clh_node = detail::clh_node<LayoutPolicy>;
+
+    public:
+        basic_CLH_RC_lock() = default;
+        LOCKS_NON_COPYABLE(basic_CLH_RC_lock);
+
+        ~basic_CLH_RC_lock()
+        {
+            detail::clh_destroy(tail);
+        }
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+        // Give up waiting once the timeout expired. A waiter that gives up
+        // leaves the queue without delaying the waiters behind it.
+        template <typename Rep, typename Period>
+        bool try_lock_for(std::chrono::duration<Rep, Period> const& timeout);
+
+        template <typename Clock, typename Duration>
+        bool try_lock_until(
+            std::chrono::time_point<Clock, Duration> const& deadline);
+
+    private:
+        template <typename TimedOut>
+        bool acquire(TimedOut&& timed_out);
+
+        alignas(policy::layout_alignment_v<LayoutPolicy, std::atomic<void*>>)
+            std::atomic<clh_node*> tail{new clh_node{}};
+
+        // Only ever touched by the current lock holder
+        clh_node* owner_node{nullptr};
+    };
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename TimedOut>
+    inline bool basic_CLH_RC_lock<WaitPolicy, LayoutPolicy>::acquire(
+        TimedOut&& timed_out)
+    {
+        clh_node* local_node = util::node_cache<clh_node>::acquire();
+
+        clh_node* const prev_node = detail::clh_enqueue<WaitPolicy>(tail,
+            local_node, timed_out, &util::node_cache<clh_node>::release,
+            "locks::CLH_RC_lock::lock");
+
+        if (prev_node == nullptr)
+            return false;
+
+        // The predecessor never looks at its node again after releasing it
+        util::node_cache<clh_node>::release(prev_node);
+        owner_node = local_node;
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_CLH_RC_lock<WaitPolicy, LayoutPolicy>::lock()
+    {
+        acquire([] { return false; });
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_CLH_RC_lock<WaitPolicy, LayoutPolicy>::try_lock()
+    {
+        return acquire([] { return true; });
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Rep, typename Period>
+    inline bool basic_CLH_RC_lock<WaitPolicy, LayoutPolicy>::try_lock_for(
+        std::chrono::duration<Rep, Period> const& timeout)
+    {
+        return try_lock_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Clock, typename Duration>
+    inline bool basic_CLH_RC_lock<WaitPolicy, LayoutPolicy>::try_lock_until(
+        std::chrono::time_point<Clock, Duration> const& deadline)
+    {
+        return acquire([&deadline] { return Clock::now() >= deadline; });
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_CLH_RC_lock<WaitPolicy, LayoutPolicy>::unlock()
+    {
+        owner_node->status.store(
+            clh_node::available(), std::memory_order_release);
+    }
+
+    using CLH_RC_lock = basic_CLH_RC_lock<policy::pause>;
+
+}    // namespace locks
@@ -2,71 +2,312 @@
 
 #pragma once
 
-#include <hpx/config.hpp>
-#include <hpx/modules/lcos_local.hpp>
-#include <hpx/modules/threading.hpp>
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+#include <util/node_cache.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 
 namespace locks {
 
-    class CLH_lock
-    {
-    private:
+    namespace detail {
+
+        // Queue node of the CLH locks. The status word follows Scott and
+        // Scherer's CLH-try lock so that a waiter can leave the queue on a
+        // timeout without blocking the waiters queued behind it:
+        //
+        //     waiting()      the owner waits for or holds the lock
+        //     available()    the owner released the lock
+        //     anything else  the owner gave up waiting, the value is the
+        //                    node it was waiting on
+        template <typename LayoutPolicy>
         struct clh_node
         {
-            clh_node() = default;
-            clh_node(std::uint64_t value)
-              : locked(value)
+            static clh_node* waiting()
+            {
+                return nullptr;
+            }
+
+            static clh_node* available()
             {
+                return reinterpret_cast<clh_node*>(std::uintptr_t(1));
             }
 
-            std::uint64_t locked{true};
+            using status_type = std::atomic<clh_node*>;
+
+            alignas(policy::layout_alignment_v<LayoutPolicy, status_type>)
+                status_type status{available()};
         };
 
+        // Queues node behind tail and waits for its predecessor to release
+        // the lock until timed_out() returns true. Returns the predecessor's
+        // node on success, which is free to be reused. Returns nullptr on
+        // timeout, node then no longer belongs to the caller. Nodes that
+        // become free along the way are passed to reclaim.
+        template <typename WaitPolicy, typename Node, typename TimedOut,
+            typename Reclaim>
+        Node* clh_enqueue(std::atomic<Node*>& tail, Node* node,
+            TimedOut&& timed_out, Reclaim&& reclaim, char const* desc)
+        {
+            node->status.store(Node::waiting(), std::memory_order_relaxed);
+
+            Node* prev_node = tail.exchange(node, std::memory_order_acq_rel);
+
+            while (true)
+            {
+                Node* status = Node::waiting();
+                WaitPolicy::wait_while(
+                    [&] {
+                        status =
+                            prev_node->status.load(std::memory_order_acquire);
+                        return status == Node::waiting() && !timed_out();
+                    },
+                    desc);
+
+                if (status == Node::available())
+                    return prev_node;
+
+                if (status != Node::waiting())
+                {
+                    // The predecessor left the queue, take over its node
+                    // and wait on the node it was waiting on instead
+                    reclaim(prev_node);
+                    prev_node = status;
+                    continue;
+                }
+
+                // Timed out. If nobody queued up behind us we can simply
+                // undo the enqueue, otherwise tell the successor where to
+                // wait now; it reclaims our node.
+                Node* expected = node;
+                if (tail.compare_exchange_strong(expected, prev_node,
+                        std::memory_order_acq_rel, std::memory_order_relaxed))
+                {
+                    reclaim(node);
+                }
+                else
+                {
+                    node->status.store(prev_node, std::memory_order_release);
+                }
+                return nullptr;
+            }
+        }
+
+        // Frees the queue left behind in a CLH lock that is not held
+        template <typename Node>
+        void clh_destroy(std::atomic<Node*>& tail)
+        {
+            Node* node = tail.load(std::memory_order_relaxed);
+            while (node != Node::waiting() && node != Node::available())
+            {
+                Node* const status =
+                    node->status.load(std::memory_order_relaxed);
+                delete node;
+                node = status;
+            }
+        }
+    }    // namespace detail
+
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact>
+    class basic_CLH_lock
+    {
     public:
-        CLH_lock() = default;
-        HPX_NON_COPYABLE(CLH_lock);
+        using clh_node = detail::clh_node<LayoutPolicy>;
+
+        // Caller-provided queue handle. CLH hands nodes from one waiter to
+        // the next, so the handle owns whichever node it got back from its
+        // predecessor on unlock and keeps it for the next acquire.
+        class clh_handle
+        {
+        public:
+            clh_handle() = default;
+            LOCKS_NON_COPYABLE(clh_handle);
+
+            ~clh_handle()
+            {
+                if (node != nullptr)
+                    util::node_cache<clh_node>::release(node);
+            }
+
+        private:
+            friend class basic_CLH_lock;
+
+            clh_node* node{nullptr};
+            clh_node* prev{nullptr};
+        };
+
+        using node_type = clh_handle;
+
+        basic_CLH_lock() = default;
+        LOCKS_NON_COPYABLE(basic_CLH_lock);
 
-        ~CLH_lock()
+        ~basic_CLH_lock()
         {
-            delete tail;
+            detail::clh_destroy(tail);
         }
 
         void lock();
+        bool try_lock();
         void unlock();
 
+        // Give up waiting once the timeout expired. A waiter that gives up
+        // leaves the queue without delaying the waiters behind it.
+        template <typename Rep, typename Period>
+        bool try_lock_for(std::chrono::duration<Rep, Period> const& timeout);
+
+        template <typename Clock, typename Duration>
+        bool try_lock_until(
+            std::chrono::time_point<Clock, Duration> const& deadline);
+
+        void lock(clh_handle& handle);
+        bool try_lock(clh_handle& handle);
+        void unlock(clh_handle& handle);
+
+        template <typename Rep, typename Period>
+        bool try_lock_for(clh_handle& handle,
+            std::chrono::duration<Rep, Period> const& timeout);
+
+        template <typename Clock, typename Duration>
+        bool try_lock_until(clh_handle& handle,
+            std::chrono::time_point<Clock, Duration> const& deadline);
+
     private:
-        std::atomic<clh_node*> tail{new clh_node(false)};
+        template <typename TimedOut>
+        bool acquire(TimedOut&& timed_out);
+
+        template <typename TimedOut>
+        bool acquire(clh_handle& handle, TimedOut&& timed_out);
+
+        alignas(policy::layout_alignment_v<LayoutPolicy, std::atomic<void*>>)
+            std::atomic<clh_node*> tail{new clh_node{}};
     };
 
-    inline void CLH_lock::lock()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename TimedOut>
+    inline bool basic_CLH_lock<WaitPolicy, LayoutPolicy>::acquire(
+        TimedOut&& timed_out)
     {
         clh_node* local_node = new clh_node{};
 
-        hpx::threads::thread_id_type id = hpx::threads::get_self_id();
-        hpx::threads::set_thread_data(
-            id, reinterpret_cast<std::size_t>(local_node));
-
         clh_node* const prev_node =
-            tail.exchange(local_node, std::memory_order_acquire);
+            detail::clh_enqueue<WaitPolicy>(tail, local_node, timed_out,
+                [](clh_node* node) { delete node; }, "locks::CLH_lock::lock");
 
-        while (prev_node->locked)
-        {
-            HPX_SMT_PAUSE;
-        }
+        if (prev_node == nullptr)
+            return false;
+
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
 
         delete prev_node;
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_CLH_lock<WaitPolicy, LayoutPolicy>::lock()
+    {
+        acquire([] { return false; });
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_CLH_lock<WaitPolicy, LayoutPolicy>::try_lock()
+    {
+        return acquire([] { return true; });
     }
 
-    inline void CLH_lock::unlock()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Rep, typename Period>
+    inline bool basic_CLH_lock<WaitPolicy, LayoutPolicy>::try_lock_for(
+        std::chrono::duration<Rep, Period> const& timeout)
+    {
+        return try_lock_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Clock, typename Duration>
+    inline bool basic_CLH_lock<WaitPolicy, LayoutPolicy>::try_lock_until(
+        std::chrono::time_point<Clock, Duration> const& deadline)
+    {
+        return acquire([&deadline] { return Clock::now() >= deadline; });
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_CLH_lock<WaitPolicy, LayoutPolicy>::unlock()
     {
-        hpx::threads::thread_id_type id = hpx::threads::get_self_id();
         clh_node* const curr_node =
-            reinterpret_cast<clh_node*>(hpx::threads::get_thread_data(id));
+            reinterpret_cast<clh_node*>(platform::get_thread_data());
 
-        curr_node->locked = false;
+        curr_node->status.store(
+            clh_node::available(), std::memory_order_release);
     }
 
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename TimedOut>
+    inline bool basic_CLH_lock<WaitPolicy, LayoutPolicy>::acquire(
+        clh_handle& handle, TimedOut&& timed_out)
+    {
+        if (handle.node == nullptr)
+            handle.node = util::node_cache<clh_node>::acquire();
+
+        handle.prev = detail::clh_enqueue<WaitPolicy>(tail, handle.node,
+            timed_out, &util::node_cache<clh_node>::release,
+            "locks::CLH_lock::lock");
+
+        if (handle.prev != nullptr)
+            return true;
+
+        // The node has been given away, get a new one next time
+        handle.node = nullptr;
+        return false;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_CLH_lock<WaitPolicy, LayoutPolicy>::lock(
+        clh_handle& handle)
+    {
+        acquire(handle, [] { return false; });
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_CLH_lock<WaitPolicy, LayoutPolicy>::try_lock(
+        clh_handle& handle)
+    {
+        return acquire(handle, [] { return true; });
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Rep, typename Period>
+    inline bool basic_CLH_lock<WaitPolicy, LayoutPolicy>::try_lock_for(
+        clh_handle& handle, std::chrono::duration<Rep, Period> const& timeout)
+    {
+        return try_lock_until(
+            handle, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Clock, typename Duration>
+    inline bool basic_CLH_lock<WaitPolicy, LayoutPolicy>::try_lock_until(
+        clh_handle& handle,
+        std::chrono::time_point<Clock, Duration> const& deadline)
+    {
+        return acquire(
+            handle, [&deadline] { return Clock::now() >= deadline; });
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_CLH_lock<WaitPolicy, LayoutPolicy>::unlock(
+        clh_handle& handle)
+    {
+        handle.node->status.store(
+            clh_node::available(), std::memory_order_release);
+
+        // Our node now belongs to the successor, recycle the predecessor's
+        handle.node = handle.prev;
+        handle.prev = nullptr;
+    }
+
+    using CLH_lock = basic_CLH_lock<policy::pause>;
+
 }    // namespace locks
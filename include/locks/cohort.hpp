@@ -0,0 +1,185 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/mcs.hpp>
+#include <locks/node-lock.hpp>
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+#include <locks/tas.hpp>
+#include <locks/ticket.hpp>
+#include <util/topology.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace locks {
+
+    // NUMA-aware cohort lock (Dice, Marathe and Shavit). Threads first take
+    // the LocalLock of their NUMA node, the owner of a local lock then takes
+    // the GlobalLock for its whole node. On release the global lock is
+    // passed on to a waiter of the same node, up to max_local_handoffs times
+    // in a row, before it is released to the other nodes. This keeps the
+    // lock and the data it protects on one socket for longer.
+    //
+    // The global lock is released by a different thread than the one that
+    // acquired it. Locks that keep their queue node in the thread data
+    // can only be used as GlobalLock through their caller-provided node API.
+    template <typename GlobalLock, typename LocalLock>
+    class basic_Cohort_lock
+    {
+    public:
+        static constexpr std::size_t default_max_local_handoffs = 64;
+
+        basic_Cohort_lock()
+          : basic_Cohort_lock(default_max_local_handoffs)
+        {
+        }
+
+        explicit basic_Cohort_lock(std::size_t max_local_handoffs)
+          : num_cohorts(util::numa_topology::get().num_nodes())
+          , cohorts(new cohort[num_cohorts])
+          , max_handoffs(max_local_handoffs)
+        {
+        }
+
+        LOCKS_NON_COPYABLE(basic_Cohort_lock);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+    private:
+        using global_node_type =
+            typename detail::node_type_of<GlobalLock>::type;
+
+        struct alignas(policy::cache_line_size) cohort
+        {
+            LocalLock local;
+            std::atomic<std::uint32_t> waiting{0};
+
+            // Only touched by the owner of the local lock
+            bool owns_global{false};
+            std::size_t handoffs{0};
+            global_node_type global_node;
+        };
+
+        void acquire_global(cohort& c);
+        bool try_acquire_global(cohort& c);
+        void release_global(cohort& c);
+
+        std::size_t const num_cohorts;
+        std::unique_ptr<cohort[]> const cohorts;
+        std::size_t const max_handoffs;
+
+        GlobalLock global;
+
+        // Only ever touched by the current lock holder
+        cohort* owner_cohort{nullptr};
+    };
+
+    template <typename GlobalLock, typename LocalLock>
+    inline void basic_Cohort_lock<GlobalLock, LocalLock>::acquire_global(
+        cohort& c)
+    {
+        if constexpr (detail::has_node_type_v<GlobalLock>)
+            global.lock(c.global_node);
+        else
+            global.lock();
+    }
+
+    template <typename GlobalLock, typename LocalLock>
+    inline bool basic_Cohort_lock<GlobalLock, LocalLock>::try_acquire_global(
+        cohort& c)
+    {
+        if constexpr (detail::has_node_type_v<GlobalLock>)
+            return global.try_lock(c.global_node);
+        else
+            return global.try_lock();
+    }
+
+    template <typename GlobalLock, typename LocalLock>
+    inline void basic_Cohort_lock<GlobalLock, LocalLock>::release_global(
+        cohort& c)
+    {
+        if constexpr (detail::has_node_type_v<GlobalLock>)
+            global.unlock(c.global_node);
+        else
+            global.unlock();
+    }
+
+    template <typename GlobalLock, typename LocalLock>
+    inline void basic_Cohort_lock<GlobalLock, LocalLock>::lock()
+    {
+        cohort& c =
+            cohorts[util::numa_topology::get().current_node() % num_cohorts];
+
+        c.waiting.fetch_add(1, std::memory_order_relaxed);
+        c.local.lock();
+        c.waiting.fetch_sub(1, std::memory_order_relaxed);
+
+        // The global lock may have been passed on within our cohort
+        if (!c.owns_global)
+        {
+            acquire_global(c);
+            c.owns_global = true;
+        }
+
+        owner_cohort = &c;
+    }
+
+    template <typename GlobalLock, typename LocalLock>
+    inline bool basic_Cohort_lock<GlobalLock, LocalLock>::try_lock()
+    {
+        cohort& c =
+            cohorts[util::numa_topology::get().current_node() % num_cohorts];
+
+        if (!c.local.try_lock())
+            return false;
+
+        if (!c.owns_global)
+        {
+            if (!try_acquire_global(c))
+            {
+                c.local.unlock();
+                return false;
+            }
+            c.owns_global = true;
+        }
+
+        owner_cohort = &c;
+        return true;
+    }
+
+    template <typename GlobalLock, typename LocalLock>
+    inline void basic_Cohort_lock<GlobalLock, LocalLock>::unlock()
+    {
+        cohort& c = *owner_cohort;
+
+        if (c.waiting.load(std::memory_order_relaxed) != 0 &&
+            c.handoffs < max_handoffs)
+        {
+            ++c.handoffs;
+            c.local.unlock();
+            return;
+        }
+
+        c.handoffs = 0;
+        c.owns_global = false;
+        release_global(c);
+        c.local.unlock();
+    }
+
+    // Ticket lock across nodes, MCS lock within a node
+    using C_TKT_MCS_lock = basic_Cohort_lock<Ticket_lock, MCS_lock>;
+
+    // Backoff test-and-set lock across nodes, MCS lock within a node
+    using C_BO_MCS_lock =
+        basic_Cohort_lock<basic_TAS_lock<policy::backoff>, MCS_lock>;
+
+    // MCS lock across and within nodes
+    using C_MCS_MCS_lock = basic_Cohort_lock<MCS_lock, MCS_lock>;
+
+}    // namespace locks
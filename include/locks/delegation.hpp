@@ -0,0 +1,268 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/flat-combining.hpp>
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace locks {
+
+    // Delegation lock in the style of remote core locking (Lozi et al.). A
+    // server task bound to one worker runs every critical section. Clients
+    // post their critical sections to cache-line sized mailboxes and the
+    // server runs them one after another, so the protected data never leaves
+    // the server's core.
+    //
+    // The server keeps its worker busy while there are requests. Critical
+    // sections run on the server task and must not call back into the same
+    // delegation lock.
+    template <typename WaitPolicy = policy::spin_suspend<>,
+        std::size_t Mailboxes = 64>
+    class basic_Delegation_lock
+    {
+    public:
+        // Runs the server on the last worker thread
+        basic_Delegation_lock()
+          : basic_Delegation_lock(platform::thread_count() - 1)
+        {
+        }
+
+        explicit basic_Delegation_lock(std::size_t server_worker);
+
+        LOCKS_NON_COPYABLE(basic_Delegation_lock);
+
+        // Serves the requests that are still outstanding, then stops the
+        // server.
+        ~basic_Delegation_lock();
+
+        // Runs f on the server and returns its result. Exceptions thrown by
+        // f are rethrown to the caller.
+        template <typename F>
+        std::invoke_result_t<F&> execute(F&& f);
+
+        // Posts f to the server without waiting for it to run
+        template <typename F>
+        platform::future<std::invoke_result_t<std::decay_t<F>&>>
+        async_execute(F&& f);
+
+        std::size_t server_worker() const
+        {
+            return server_worker_;
+        }
+
+    private:
+        // mailbox::state values
+        static constexpr std::uint32_t empty = 0;
+        static constexpr std::uint32_t claimed = 1;
+        static constexpr std::uint32_t pending = 2;
+        static constexpr std::uint32_t done = 3;
+
+        // The server yields its worker between polls once it found no
+        // request for that many polls in a row.
+        static constexpr std::size_t idle_polls = 1024;
+
+        struct alignas(policy::cache_line_size) mailbox
+        {
+            std::atomic<std::uint32_t> state{empty};
+
+            // Nobody waits for the request to be done, the server empties
+            // the mailbox itself
+            bool detached{false};
+
+            void (*invoke)(void*){nullptr};
+            void* request{nullptr};
+        };
+
+        // Critical section posted through async_execute(), owns its callable
+        // and deletes itself once it ran
+        template <typename F>
+        struct async_request
+        {
+            using result_type = std::invoke_result_t<F&>;
+
+            static void invoke(void* p)
+            {
+                std::unique_ptr<async_request> r(
+                    static_cast<async_request*>(p));
+                try
+                {
+                    if constexpr (std::is_void_v<result_type>)
+                    {
+                        r->f();
+                        r->promise.set_value();
+                    }
+                    else
+                    {
+                        r->promise.set_value(r->f());
+                    }
+                }
+                catch (...)
+                {
+                    r->promise.set_exception(std::current_exception());
+                }
+            }
+
+            F f;
+            platform::promise<result_type> promise{};
+        };
+
+        mailbox& post(void (*invoke)(void*), void* request, bool detached);
+
+        bool serve();
+        void run_server();
+
+        mailbox mailboxes[Mailboxes];
+
+        std::size_t const server_worker_;
+        std::atomic<bool> stop{false};
+        platform::future<void> server;
+    };
+
+    template <typename WaitPolicy, std::size_t Mailboxes>
+    inline basic_Delegation_lock<WaitPolicy,
+        Mailboxes>::basic_Delegation_lock(std::size_t server_worker)
+      : server_worker_(server_worker)
+    {
+        server =
+            platform::run_on_worker(server_worker, [this] { run_server(); });
+    }
+
+    template <typename WaitPolicy, std::size_t Mailboxes>
+    inline basic_Delegation_lock<WaitPolicy,
+        Mailboxes>::~basic_Delegation_lock()
+    {
+        stop.store(true, std::memory_order_release);
+        server.get();
+    }
+
+    template <typename WaitPolicy, std::size_t Mailboxes>
+    inline void basic_Delegation_lock<WaitPolicy, Mailboxes>::run_server()
+    {
+        std::size_t idle = 0;
+        while (true)
+        {
+            // Everything posted before stop was set is served below
+            bool const stopping = stop.load(std::memory_order_acquire);
+
+            if (serve())
+            {
+                idle = 0;
+                continue;
+            }
+
+            if (stopping)
+                return;
+
+            if (++idle < idle_polls)
+                platform::pause();
+            else
+                platform::yield();
+        }
+    }
+
+    // One pass over the mailboxes, returns whether any request was served
+    template <typename WaitPolicy, std::size_t Mailboxes>
+    inline bool basic_Delegation_lock<WaitPolicy, Mailboxes>::serve()
+    {
+        bool served = false;
+        for (mailbox& box : mailboxes)
+        {
+            if (box.state.load(std::memory_order_acquire) != pending)
+                continue;
+
+            bool const detached = box.detached;
+            box.invoke(box.request);
+            box.state.store(detached ? empty : done, std::memory_order_release);
+            served = true;
+        }
+        return served;
+    }
+
+    template <typename WaitPolicy, std::size_t Mailboxes>
+    inline typename basic_Delegation_lock<WaitPolicy, Mailboxes>::mailbox&
+    basic_Delegation_lock<WaitPolicy, Mailboxes>::post(
+        void (*invoke)(void*), void* request, bool detached)
+    {
+        // Start probing at a worker-specific mailbox to keep clients apart
+        std::size_t const first = platform::thread_index();
+
+        mailbox* claimed_box = nullptr;
+        WaitPolicy::wait_while(
+            [this, first, &claimed_box] {
+                for (std::size_t i = 0; i != Mailboxes; ++i)
+                {
+                    mailbox& box = mailboxes[(first + i) % Mailboxes];
+
+                    std::uint32_t expected = empty;
+                    if (box.state.load(std::memory_order_relaxed) == empty &&
+                        box.state.compare_exchange_strong(expected, claimed,
+                            std::memory_order_acquire,
+                            std::memory_order_relaxed))
+                    {
+                        claimed_box = &box;
+                        return false;
+                    }
+                }
+                return true;
+            },
+            "locks::Delegation_lock::post");
+
+        claimed_box->detached = detached;
+        claimed_box->invoke = invoke;
+        claimed_box->request = request;
+        claimed_box->state.store(pending, std::memory_order_release);
+
+        return *claimed_box;
+    }
+
+    template <typename WaitPolicy, std::size_t Mailboxes>
+    template <typename F>
+    inline std::invoke_result_t<F&>
+    basic_Delegation_lock<WaitPolicy, Mailboxes>::execute(F&& f)
+    {
+        using request_type =
+            detail::combining_request<std::remove_reference_t<F>>;
+        request_type req{f};
+
+        mailbox& box = post(&request_type::invoke, &req, false);
+
+        WaitPolicy::wait_while(
+            [&box] {
+                return box.state.load(std::memory_order_acquire) != done;
+            },
+            "locks::Delegation_lock::execute");
+
+        box.state.store(empty, std::memory_order_release);
+
+        if (req.error)
+            std::rethrow_exception(req.error);
+
+        return req.result.get();
+    }
+
+    template <typename WaitPolicy, std::size_t Mailboxes>
+    template <typename F>
+    inline platform::future<std::invoke_result_t<std::decay_t<F>&>>
+    basic_Delegation_lock<WaitPolicy, Mailboxes>::async_execute(F&& f)
+    {
+        using request_type = async_request<std::decay_t<F>>;
+
+        auto* req = new request_type{std::forward<F>(f)};
+        auto result = req->promise.get_future();
+
+        post(&request_type::invoke, req, true);
+        return result;
+    }
+
+    using Delegation_lock = basic_Delegation_lock<>;
+
+}    // namespace locks
@@ -0,0 +1,266 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+#include <locks/ttas.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace locks {
+
+    namespace detail {
+
+        // Result of a critical section that may be run by another thread
+        template <typename R>
+        struct combining_result
+        {
+            template <typename F>
+            void run(F& f)
+            {
+                value.emplace(f());
+            }
+
+            R get()
+            {
+                return std::move(*value);
+            }
+
+            std::optional<R> value;
+        };
+
+        template <typename R>
+        struct combining_result<R&>
+        {
+            template <typename F>
+            void run(F& f)
+            {
+                value = &f();
+            }
+
+            R& get()
+            {
+                return *value;
+            }
+
+            R* value{nullptr};
+        };
+
+        template <>
+        struct combining_result<void>
+        {
+            template <typename F>
+            void run(F& f)
+            {
+                f();
+            }
+
+            void get() {}
+        };
+
+        // Critical section published by a caller that waits for another
+        // thread to run it
+        template <typename F>
+        struct combining_request
+        {
+            static void invoke(void* p)
+            {
+                combining_request& r = *static_cast<combining_request*>(p);
+                try
+                {
+                    r.result.run(r.f);
+                }
+                catch (...)
+                {
+                    r.error = std::current_exception();
+                }
+            }
+
+            F& f;
+            combining_result<std::invoke_result_t<F&>> result{};
+            std::exception_ptr error{};
+        };
+    }    // namespace detail
+
+    // Flat-combining lock (Hendler, Incze, Shavit and Tzafrir). execute(f)
+    // runs f under the lock. A caller that finds the lock taken publishes f
+    // in a publication slot instead of waiting for the lock, the lock holder
+    // runs the published critical sections in batches before it releases the
+    // lock. The protected data stays in the holder's cache meanwhile, instead
+    // of moving to a different core for every critical section.
+    //
+    // Slots bounds the number of requests published at the same time, a
+    // caller that finds every slot taken acquires the LockType directly.
+    template <typename LockType = TTAS_lock,
+        typename WaitPolicy = policy::pause, std::size_t Slots = 64>
+    class basic_Flat_combining_lock
+    {
+    public:
+        basic_Flat_combining_lock() = default;
+        LOCKS_NON_COPYABLE(basic_Flat_combining_lock);
+
+        // Runs f under the lock, possibly on a different thread, and returns
+        // its result. Exceptions thrown by f are rethrown to the caller.
+        template <typename F>
+        std::invoke_result_t<F&> execute(F&& f);
+
+        // Plain Lockable interface, unlock() serves the published requests
+        // before it releases the lock.
+        void lock();
+        bool try_lock();
+        void unlock();
+
+    private:
+        // publication_slot::state values
+        static constexpr std::uint32_t empty = 0;
+        static constexpr std::uint32_t claimed = 1;
+        static constexpr std::uint32_t pending = 2;
+        static constexpr std::uint32_t done = 3;
+
+        // Combining stops after a pass over the slots that found no request
+        // or after that many passes.
+        static constexpr std::size_t max_passes = 4;
+
+        struct alignas(policy::cache_line_size) publication_slot
+        {
+            std::atomic<std::uint32_t> state{empty};
+            void (*invoke)(void*){nullptr};
+            void* request{nullptr};
+        };
+
+        publication_slot* publish(void (*invoke)(void*), void* request);
+        void combine();
+
+        LockType lock_;
+        publication_slot slots[Slots];
+    };
+
+    template <typename LockType, typename WaitPolicy, std::size_t Slots>
+    template <typename F>
+    inline std::invoke_result_t<F&>
+    basic_Flat_combining_lock<LockType, WaitPolicy, Slots>::execute(F&& f)
+    {
+        if (lock_.try_lock())
+        {
+            std::lock_guard<basic_Flat_combining_lock> guard(
+                *this, std::adopt_lock);
+            return f();
+        }
+
+        using request_type =
+            detail::combining_request<std::remove_reference_t<F>>;
+        request_type req{f};
+
+        publication_slot* const slot = publish(&request_type::invoke, &req);
+        if (slot == nullptr)
+        {
+            std::lock_guard<basic_Flat_combining_lock> guard(*this);
+            return f();
+        }
+
+        // Wait for a combiner to run our request, or become the combiner
+        // ourselves once the lock is free. Our request is still pending
+        // then and served by our own combining pass.
+        WaitPolicy::wait_while(
+            [this, slot] {
+                if (slot->state.load(std::memory_order_acquire) == done)
+                    return false;
+
+                if (lock_.try_lock())
+                {
+                    unlock();
+                    return false;
+                }
+                return true;
+            },
+            "locks::Flat_combining_lock::execute");
+
+        slot->state.store(empty, std::memory_order_release);
+
+        if (req.error)
+            std::rethrow_exception(req.error);
+
+        return req.result.get();
+    }
+
+    template <typename LockType, typename WaitPolicy, std::size_t Slots>
+    inline typename basic_Flat_combining_lock<LockType, WaitPolicy,
+        Slots>::publication_slot*
+    basic_Flat_combining_lock<LockType, WaitPolicy, Slots>::publish(
+        void (*invoke)(void*), void* request)
+    {
+        // Start probing at a worker-specific slot to keep callers apart
+        std::size_t const first = platform::thread_index();
+
+        for (std::size_t i = 0; i != Slots; ++i)
+        {
+            publication_slot& slot = slots[(first + i) % Slots];
+
+            std::uint32_t expected = empty;
+            if (slot.state.load(std::memory_order_relaxed) == empty &&
+                slot.state.compare_exchange_strong(expected, claimed,
+                    std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                slot.invoke = invoke;
+                slot.request = request;
+                slot.state.store(pending, std::memory_order_release);
+                return &slot;
+            }
+        }
+
+        return nullptr;
+    }
+
+    template <typename LockType, typename WaitPolicy, std::size_t Slots>
+    inline void
+    basic_Flat_combining_lock<LockType, WaitPolicy, Slots>::combine()
+    {
+        for (std::size_t pass = 0; pass != max_passes; ++pass)
+        {
+            bool served = false;
+            for (publication_slot& slot : slots)
+            {
+                if (slot.state.load(std::memory_order_acquire) == pending)
+                {
+                    slot.invoke(slot.request);
+                    slot.state.store(done, std::memory_order_release);
+                    served = true;
+                }
+            }
+
+            if (!served)
+                break;
+        }
+    }
+
+    template <typename LockType, typename WaitPolicy, std::size_t Slots>
+    inline void basic_Flat_combining_lock<LockType, WaitPolicy, Slots>::lock()
+    {
+        lock_.lock();
+    }
+
+    template <typename LockType, typename WaitPolicy, std::size_t Slots>
+    inline bool
+    basic_Flat_combining_lock<LockType, WaitPolicy, Slots>::try_lock()
+    {
+        return lock_.try_lock();
+    }
+
+    template <typename LockType, typename WaitPolicy, std::size_t Slots>
+    inline void basic_Flat_combining_lock<LockType, WaitPolicy, Slots>::unlock()
+    {
+        combine();
+        lock_.unlock();
+    }
+
+    using Flat_combining_lock = basic_Flat_combining_lock<>;
+
+}    // namespace locks
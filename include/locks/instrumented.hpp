@@ -0,0 +1,256 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+#include <util/contention.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace locks {
+
+    namespace detail {
+
+        template <typename LockType, typename Enable = void>
+        struct is_lockable : std::false_type
+        {
+        };
+
+        template <typename LockType>
+        struct is_lockable<LockType,
+            std::void_t<decltype(std::declval<LockType&>().lock())>>
+          : std::true_type
+        {
+        };
+
+        template <typename LockType, typename Enable = void>
+        struct has_is_locked : std::false_type
+        {
+        };
+
+        template <typename LockType>
+        struct has_is_locked<LockType,
+            std::void_t<decltype(std::declval<LockType&>().is_locked())>>
+          : std::true_type
+        {
+        };
+
+        // LockType waiting through policy::counting, i.e. the locks of this
+        // library with their wait policy swapped out. Locks whose wait
+        // policy cannot be swapped stay as they are and count no polls.
+        template <typename LockType, typename Enable = void>
+        struct counted_lock
+        {
+            using type = LockType;
+        };
+
+        template <typename LockType>
+        using counted_lock_t = typename counted_lock<LockType>::type;
+
+        // basic_TTAS_lock<WaitPolicy, LayoutPolicy> and friends
+        template <template <typename, typename> class Lock,
+            typename WaitPolicy, typename LayoutPolicy>
+        struct counted_lock<Lock<WaitPolicy, LayoutPolicy>,
+            std::enable_if_t<policy::detail::is_wait_policy<WaitPolicy>::value>>
+        {
+            using type = Lock<policy::counting<WaitPolicy>, LayoutPolicy>;
+        };
+
+        // basic_Anderson_lock<WaitPolicy, LayoutPolicy, Slots> and friends
+        template <template <typename, typename, std::size_t> class Lock,
+            typename WaitPolicy, typename LayoutPolicy, std::size_t N>
+        struct counted_lock<Lock<WaitPolicy, LayoutPolicy, N>,
+            std::enable_if_t<policy::detail::is_wait_policy<WaitPolicy>::value>>
+        {
+            using type = Lock<policy::counting<WaitPolicy>, LayoutPolicy, N>;
+        };
+
+        // basic_Cohort_lock<GlobalLock, LocalLock>
+        template <template <typename, typename> class Lock,
+            typename GlobalLock, typename LocalLock>
+        struct counted_lock<Lock<GlobalLock, LocalLock>,
+            std::enable_if_t<is_lockable<GlobalLock>::value &&
+                is_lockable<LocalLock>::value>>
+        {
+            using type =
+                Lock<counted_lock_t<GlobalLock>, counted_lock_t<LocalLock>>;
+        };
+    }    // namespace detail
+
+    // Wraps LockType and counts its acquisitions, the acquisitions that had
+    // to wait, the polls of its wait policy while waiting and the time it was
+    // held, see util::contention_counters.
+    //
+    // Polls are counted by waiting through policy::counting, which replaces
+    // the wait policy of the locks of this library (see
+    // detail::counted_lock), the unwrapped locks never count. An acquisition
+    // is contended if it polled at least once or got resumed on a different
+    // worker, whose polls are not counted. Locks without a wait policy are
+    // checked with is_locked() before acquiring them or, lacking that,
+    // try_lock()ed first.
+    template <typename LockType>
+    class instrumented
+    {
+    public:
+        // Counts into counters of its own
+        instrumented()
+          : counters_(std::make_shared<util::contention_counters>())
+        {
+        }
+
+        // Counts into the counters registered under name, which are shared
+        // with all other locks of that name and, with HPX, exposed as
+        // performance counters, see util::contention_registry
+        explicit instrumented(std::string const& name)
+          : counters_(util::contention_registry::get().counters(name))
+        {
+        }
+
+        LOCKS_NON_COPYABLE(instrumented);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+        // Only available if LockType supports timed acquisition
+        template <typename Rep, typename Period>
+        bool try_lock_for(std::chrono::duration<Rep, Period> const& timeout);
+
+        template <typename Clock, typename Duration>
+        bool try_lock_until(
+            std::chrono::time_point<Clock, Duration> const& deadline);
+
+        util::contention_stats stats() const
+        {
+            return counters_->stats();
+        }
+
+        util::contention_counters& counters() const
+        {
+            return *counters_;
+        }
+
+    private:
+        static constexpr bool counts_polls =
+            !std::is_same_v<detail::counted_lock_t<LockType>, LockType>;
+
+        // Calls try_acquire(), which returns whether it got the lock, and
+        // records the acquisition
+        template <typename Acquire>
+        bool acquire(Acquire&& try_acquire);
+
+        void acquired(bool contended, std::uint64_t polls);
+
+        detail::counted_lock_t<LockType> lock_;
+        std::shared_ptr<util::contention_counters> counters_;
+
+        // Only ever touched by the current lock holder
+        std::uint64_t acquired_at{0};
+    };
+
+    template <typename LockType>
+    template <typename Acquire>
+    inline bool instrumented<LockType>::acquire(Acquire&& try_acquire)
+    {
+        if constexpr (counts_polls)
+        {
+            std::size_t const worker = platform::thread_index();
+            std::uint64_t const polls_before = policy::detail::worker_polls();
+
+            if (!try_acquire())
+                return false;
+
+            if (platform::thread_index() != worker)
+            {
+                acquired(true, 0);
+                return true;
+            }
+
+            std::uint64_t const polls =
+                policy::detail::worker_polls() - polls_before;
+            acquired(polls != 0, polls);
+        }
+        else if constexpr (detail::has_is_locked<LockType>::value)
+        {
+            bool const contended = lock_.is_locked();
+            if (!try_acquire())
+                return false;
+
+            acquired(contended, 0);
+        }
+        else
+        {
+            if (lock_.try_lock())
+            {
+                acquired(false, 0);
+                return true;
+            }
+
+            if (!try_acquire())
+                return false;
+
+            acquired(true, 0);
+        }
+        return true;
+    }
+
+    template <typename LockType>
+    inline void instrumented<LockType>::acquired(
+        bool contended, std::uint64_t polls)
+    {
+        counters_->record_acquire(contended, polls);
+        acquired_at = platform::now();
+    }
+
+    template <typename LockType>
+    inline void instrumented<LockType>::lock()
+    {
+        acquire([this] {
+            lock_.lock();
+            return true;
+        });
+    }
+
+    template <typename LockType>
+    inline bool instrumented<LockType>::try_lock()
+    {
+        if (!lock_.try_lock())
+            return false;
+
+        acquired(false, 0);
+        return true;
+    }
+
+    template <typename LockType>
+    template <typename Rep, typename Period>
+    inline bool instrumented<LockType>::try_lock_for(
+        std::chrono::duration<Rep, Period> const& timeout)
+    {
+        return try_lock_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename LockType>
+    template <typename Clock, typename Duration>
+    inline bool instrumented<LockType>::try_lock_until(
+        std::chrono::time_point<Clock, Duration> const& deadline)
+    {
+        return acquire([this, &deadline] {
+            return lock_.try_lock_until(deadline);
+        });
+    }
+
+    template <typename LockType>
+    inline void instrumented<LockType>::unlock()
+    {
+        counters_->record_release(platform::now() - acquired_at);
+        lock_.unlock();
+    }
+
+}    // namespace locks
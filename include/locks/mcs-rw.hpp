@@ -0,0 +1,379 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+#include <util/node_cache.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace locks {
+
+    // Fair reader-writer queue lock (Mellor-Crummey and Scott). Readers and
+    // writers queue up in FIFO order, every waiter spins on its own node and
+    // consecutive readers in the queue hold the lock together.
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact>
+    class basic_MCS_RW_lock
+    {
+        using state_type = std::atomic<std::uint32_t>;
+
+    public:
+        // Queue node for callers that want to provide their own storage,
+        // e.g. on the stack. The node must stay alive until unlock(node) or
+        // unlock_shared(node) returns.
+        struct rw_node
+        {
+            alignas(policy::layout_alignment_v<LayoutPolicy, state_type>)
+                state_type state{0};
+            std::atomic<rw_node*> next{nullptr};
+            bool is_writer{false};
+        };
+
+        using node_type = rw_node;
+
+        basic_MCS_RW_lock() = default;
+        LOCKS_NON_COPYABLE(basic_MCS_RW_lock);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+        void lock_shared();
+        bool try_lock_shared();
+        void unlock_shared();
+
+        void lock(rw_node& node);
+        bool try_lock(rw_node& node);
+        void unlock(rw_node& node);
+
+        void lock_shared(rw_node& node);
+        bool try_lock_shared(rw_node& node);
+        void unlock_shared(rw_node& node);
+
+    private:
+        // rw_node::state bits
+        static constexpr std::uint32_t blocked = 0x1;
+        static constexpr std::uint32_t successor_reader = 0x2;
+        static constexpr std::uint32_t successor_writer = 0x4;
+
+        static constexpr std::size_t alignment =
+            policy::layout_alignment_v<LayoutPolicy, std::atomic<void*>>;
+
+        static void wait_while_blocked(rw_node& node, char const* desc);
+        static void unblock(rw_node& node);
+
+        rw_node* wait_for_successor(rw_node& node);
+        void admit_successor_reader(rw_node& node);
+
+        static rw_node* node_from_thread_data();
+
+        alignas(alignment) std::atomic<rw_node*> tail{nullptr};
+        alignas(alignment) std::atomic<std::uint32_t> reader_count{0};
+        alignas(alignment) std::atomic<rw_node*> next_writer{nullptr};
+    };
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::wait_while_blocked(
+        rw_node& node, char const* desc)
+    {
+        WaitPolicy::wait_while(
+            [&node] {
+                return (node.state.load(std::memory_order_acquire) &
+                           blocked) != 0;
+            },
+            desc);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::unblock(
+        rw_node& node)
+    {
+        node.state.fetch_and(~blocked, std::memory_order_release);
+    }
+
+    // Returns the successor of node, waiting for it to link itself in if it
+    // already swapped itself into the tail.
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline typename basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::rw_node*
+    basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::wait_for_successor(
+        rw_node& node)
+    {
+        rw_node* next = node.next.load(std::memory_order_acquire);
+        if (next != nullptr)
+            return next;
+
+        rw_node* p = &node;
+        if (tail.compare_exchange_strong(p, nullptr, std::memory_order_release,
+                std::memory_order_relaxed))
+            return nullptr;
+
+        while ((next = node.next.load(std::memory_order_acquire)) == nullptr)
+        {
+            platform::pause();
+        }
+        return next;
+    }
+
+    // Readers that queued up behind a reader while it was waiting enter
+    // together with it.
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void
+    basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::admit_successor_reader(
+        rw_node& node)
+    {
+        if (node.state.load(std::memory_order_acquire) & successor_reader)
+        {
+            rw_node* next;
+            while ((next = node.next.load(std::memory_order_acquire)) ==
+                nullptr)
+            {
+                platform::pause();
+            }
+
+            reader_count.fetch_add(1);
+            unblock(*next);
+        }
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::lock(
+        rw_node& node)
+    {
+        node.is_writer = true;
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.state.store(blocked, std::memory_order_relaxed);
+
+        rw_node* const prev_node =
+            tail.exchange(&node, std::memory_order_acq_rel);
+
+        if (prev_node == nullptr)
+        {
+            // The queue is empty but readers may still be inside, the last
+            // of them hands the lock to next_writer.
+            next_writer.store(&node);
+            if (reader_count.load() == 0 &&
+                next_writer.exchange(nullptr) == &node)
+                unblock(node);
+        }
+        else
+        {
+            prev_node->state.fetch_or(
+                successor_writer, std::memory_order_relaxed);
+            prev_node->next.store(&node, std::memory_order_release);
+        }
+
+        wait_while_blocked(node, "locks::MCS_RW_lock::lock");
+    }
+
+    // Succeeds only if the queue is empty and no reader is inside. A reader
+    // sneaking in and out of the queue right before us can still make us
+    // wait for it to leave, but only if somebody queued up behind us in the
+    // meantime so that we cannot undo the enqueue.
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::try_lock(
+        rw_node& node)
+    {
+        if (reader_count.load() != 0)
+            return false;
+
+        node.is_writer = true;
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.state.store(blocked, std::memory_order_relaxed);
+
+        rw_node* expected = nullptr;
+        if (!tail.compare_exchange_strong(expected, &node,
+                std::memory_order_acq_rel, std::memory_order_relaxed))
+            return false;
+
+        if (reader_count.load() != 0)
+        {
+            expected = &node;
+            if (tail.compare_exchange_strong(expected, nullptr,
+                    std::memory_order_release, std::memory_order_relaxed))
+                return false;
+        }
+
+        next_writer.store(&node);
+        if (reader_count.load() == 0 && next_writer.exchange(nullptr) == &node)
+            unblock(node);
+
+        wait_while_blocked(node, "locks::MCS_RW_lock::try_lock");
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::unlock(
+        rw_node& node)
+    {
+        rw_node* const next = wait_for_successor(node);
+        if (next == nullptr)
+            return;
+
+        if (!next->is_writer)
+            reader_count.fetch_add(1);
+        unblock(*next);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::lock_shared(
+        rw_node& node)
+    {
+        node.is_writer = false;
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.state.store(blocked, std::memory_order_relaxed);
+
+        rw_node* const prev_node =
+            tail.exchange(&node, std::memory_order_acq_rel);
+
+        if (prev_node == nullptr)
+        {
+            reader_count.fetch_add(1);
+            unblock(node);
+        }
+        else
+        {
+            std::uint32_t expected = blocked;
+            if (prev_node->is_writer ||
+                prev_node->state.compare_exchange_strong(expected,
+                    blocked | successor_reader, std::memory_order_acq_rel))
+            {
+                // The predecessor is a writer or a waiting reader, it will
+                // count us in and wake us up.
+                prev_node->next.store(&node, std::memory_order_release);
+                wait_while_blocked(node, "locks::MCS_RW_lock::lock_shared");
+            }
+            else
+            {
+                // The predecessor is an active reader, join it.
+                reader_count.fetch_add(1);
+                prev_node->next.store(&node, std::memory_order_release);
+                unblock(node);
+            }
+        }
+
+        admit_successor_reader(node);
+    }
+
+    // Succeeds only if the queue is empty. Joining readers already holding
+    // the lock would require looking at the tail node, which may be
+    // recycled at any time.
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::try_lock_shared(
+        rw_node& node)
+    {
+        node.is_writer = false;
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.state.store(blocked, std::memory_order_relaxed);
+
+        rw_node* expected = nullptr;
+        if (!tail.compare_exchange_strong(expected, &node,
+                std::memory_order_acq_rel, std::memory_order_relaxed))
+            return false;
+
+        reader_count.fetch_add(1);
+        unblock(node);
+
+        admit_successor_reader(node);
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::unlock_shared(
+        rw_node& node)
+    {
+        rw_node* const next = wait_for_successor(node);
+        if (next != nullptr &&
+            (node.state.load(std::memory_order_acquire) & successor_writer))
+        {
+            next_writer.store(next);
+        }
+
+        // The last reader out wakes up the writer waiting for them
+        if (reader_count.fetch_sub(1) == 1)
+        {
+            rw_node* writer = next_writer.load();
+            if (writer != nullptr && reader_count.load() == 0 &&
+                next_writer.compare_exchange_strong(writer, nullptr))
+            {
+                unblock(*writer);
+            }
+        }
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline typename basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::rw_node*
+    basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::node_from_thread_data()
+    {
+        return reinterpret_cast<rw_node*>(platform::get_thread_data());
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::lock()
+    {
+        rw_node* local_node = util::node_cache<rw_node>::acquire();
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
+
+        lock(*local_node);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::try_lock()
+    {
+        rw_node* local_node = util::node_cache<rw_node>::acquire();
+        if (!try_lock(*local_node))
+        {
+            util::node_cache<rw_node>::release(local_node);
+            return false;
+        }
+
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
+
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::unlock()
+    {
+        rw_node* const curr_node = node_from_thread_data();
+        unlock(*curr_node);
+        util::node_cache<rw_node>::release(curr_node);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::lock_shared()
+    {
+        rw_node* local_node = util::node_cache<rw_node>::acquire();
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
+
+        lock_shared(*local_node);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::try_lock_shared()
+    {
+        rw_node* local_node = util::node_cache<rw_node>::acquire();
+        if (!try_lock_shared(*local_node))
+        {
+            util::node_cache<rw_node>::release(local_node);
+            return false;
+        }
+
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
+
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_RW_lock<WaitPolicy, LayoutPolicy>::unlock_shared()
+    {
+        rw_node* const curr_node = node_from_thread_data();
+        unlock_shared(*curr_node);
+        util::node_cache<rw_node>::release(curr_node);
+    }
+
+    using MCS_RW_lock = basic_MCS_RW_lock<policy::pause>;
+
+}    // namespace locks
@@ -2,83 +2,150 @@
 
 #pragma once
 
-#include <hpx/config.hpp>
-#include <hpx/modules/lcos_local.hpp>
-#include <hpx/modules/threading.hpp>
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
 
 #include <atomic>
 #include <cstdint>
 
 namespace locks {
 
-    class MCS_lock
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact>
+    class basic_MCS_lock
     {
-    private:
+    public:
+        // Queue node for callers that want to provide their own storage,
+        // e.g. on the stack. The node must stay alive until unlock(node)
+        // returns.
         struct mcs_node
         {
-            std::uint32_t locked{false};
-            mcs_node* next{nullptr};
+            alignas(policy::layout_alignment_v<LayoutPolicy, std::atomic<bool>>)
+                std::atomic<bool> locked{false};
+            std::atomic<mcs_node*> next{nullptr};
         };
 
-    public:
-        MCS_lock() = default;
-        HPX_NON_COPYABLE(MCS_lock);
+        using node_type = mcs_node;
 
-        ~MCS_lock() = default;
+        basic_MCS_lock() = default;
+        LOCKS_NON_COPYABLE(basic_MCS_lock);
+
+        ~basic_MCS_lock() = default;
 
         void lock();
+        bool try_lock();
         void unlock();
 
+        void lock(mcs_node& node);
+        bool try_lock(mcs_node& node);
+        void unlock(mcs_node& node);
+
+        bool is_locked();
+
     private:
-        std::atomic<mcs_node*> tail{nullptr};
+        alignas(policy::layout_alignment_v<LayoutPolicy, std::atomic<void*>>)
+            std::atomic<mcs_node*> tail{nullptr};
     };
 
-    inline void MCS_lock::lock()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_lock<WaitPolicy, LayoutPolicy>::lock()
     {
         mcs_node* local_node = new mcs_node{};
-        hpx::threads::thread_id_type id = hpx::threads::get_self_id();
-        hpx::threads::set_thread_data(
-            id, reinterpret_cast<std::size_t>(local_node));
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
+
+        lock(*local_node);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_MCS_lock<WaitPolicy, LayoutPolicy>::try_lock()
+    {
+        // Fail without allocating a node while someone is queued
+        if (tail.load(std::memory_order_relaxed) != nullptr)
+            return false;
+
+        mcs_node* local_node = new mcs_node{};
+        if (!try_lock(*local_node))
+        {
+            delete local_node;
+            return false;
+        }
+
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
+
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_lock<WaitPolicy, LayoutPolicy>::unlock()
+    {
+        mcs_node* const curr_node =
+            reinterpret_cast<mcs_node*>(platform::get_thread_data());
+
+        unlock(*curr_node);
+
+        delete curr_node;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_lock<WaitPolicy, LayoutPolicy>::lock(mcs_node& node)
+    {
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.locked.store(true, std::memory_order_relaxed);
 
         mcs_node* const prev_node =
-            tail.exchange(local_node, std::memory_order_acquire);
+            tail.exchange(&node, std::memory_order_acq_rel);
 
         if (prev_node != nullptr)
         {
-            local_node->locked = true;
+            prev_node->next.store(&node, std::memory_order_release);
 
-            prev_node->next = local_node;
-
-            while (local_node->locked)
-            {
-                HPX_SMT_PAUSE;
-            }
+            WaitPolicy::wait_while(
+                [&node] { return node.locked.load(std::memory_order_acquire); },
+                "locks::MCS_lock::lock");
         }
     }
 
-    inline void MCS_lock::unlock()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_MCS_lock<WaitPolicy, LayoutPolicy>::try_lock(
+        mcs_node& node)
     {
-        hpx::threads::thread_id_type id = hpx::threads::get_self_id();
-        mcs_node* const curr_node =
-            reinterpret_cast<mcs_node*>(hpx::threads::get_thread_data(id));
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.locked.store(true, std::memory_order_relaxed);
 
-        if (curr_node->next == nullptr)
+        // Only enqueue into an empty queue, we never have to wait then
+        mcs_node* expected = nullptr;
+        return tail.compare_exchange_strong(expected, &node,
+            std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_MCS_lock<WaitPolicy, LayoutPolicy>::unlock(
+        mcs_node& node)
+    {
+        if (node.next.load(std::memory_order_acquire) == nullptr)
         {
-            mcs_node* p = curr_node;
+            mcs_node* p = &node;
             if (tail.compare_exchange_strong(p, nullptr,
                     std::memory_order_release, std::memory_order_relaxed))
                 return;
 
-            while (curr_node->next == nullptr)
+            // The successor is in the middle of linking itself in
+            while (node.next.load(std::memory_order_acquire) == nullptr)
             {
-                HPX_SMT_PAUSE;
+                platform::pause();
             }
         }
 
-        curr_node->next->locked = false;
-        curr_node->next = nullptr;
+        node.next.load(std::memory_order_acquire)
+            ->locked.store(false, std::memory_order_release);
+    }
 
-        delete curr_node;
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_MCS_lock<WaitPolicy, LayoutPolicy>::is_locked()
+    {
+        return tail.load(std::memory_order_acquire) != nullptr;
     }
 
+    using MCS_lock = basic_MCS_lock<policy::pause>;
+
 }    // namespace locks
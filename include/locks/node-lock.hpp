@@ -0,0 +1,113 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+
+#include <chrono>
+#include <type_traits>
+
+namespace locks {
+
+    namespace detail {
+
+        struct no_node
+        {
+        };
+
+        // Queue locks expose the type of their caller-provided node
+        template <typename LockType, typename Enable = void>
+        struct node_type_of
+        {
+            using type = no_node;
+        };
+
+        template <typename LockType>
+        struct node_type_of<LockType,
+            std::void_t<typename LockType::node_type>>
+        {
+            using type = typename LockType::node_type;
+        };
+
+        template <typename LockType>
+        inline constexpr bool has_node_type_v = !std::is_same_v<
+            typename node_type_of<LockType>::type, no_node>;
+    }    // namespace detail
+
+    // Binds a queue lock (MCS_lock, MCS_BO_lock, CLH_lock, CLH_BO_lock) to a
+    // node owned by the caller. The result is Lockable and can be used with
+    // std::lock_guard, std::unique_lock and friends. Using one node_lock per
+    // lock allows a single thread to hold several queue locks at once, e.g.
+    // for nested or hand-over-hand locking, without going through the
+    // thread data or the allocator.
+    template <typename LockType>
+    class node_lock
+    {
+    public:
+        explicit node_lock(LockType& lock)
+          : lock_(lock)
+        {
+        }
+
+        LOCKS_NON_COPYABLE(node_lock);
+
+        void lock()
+        {
+            lock_.lock(node_);
+        }
+
+        bool try_lock()
+        {
+            return lock_.try_lock(node_);
+        }
+
+        // Only available for queue locks with timed acquisition (CLH_lock,
+        // CLH_BO_lock)
+        template <typename Rep, typename Period>
+        bool try_lock_for(std::chrono::duration<Rep, Period> const& timeout)
+        {
+            return lock_.try_lock_for(node_, timeout);
+        }
+
+        template <typename Clock, typename Duration>
+        bool try_lock_until(
+            std::chrono::time_point<Clock, Duration> const& deadline)
+        {
+            return lock_.try_lock_until(node_, deadline);
+        }
+
+        void unlock()
+        {
+            lock_.unlock(node_);
+        }
+
+    private:
+        LockType& lock_;
+        typename LockType::node_type node_;
+    };
+
+    // Scoped guard keeping the queue node on the stack for the lifetime of
+    // the critical section.
+    template <typename LockType>
+    class queue_guard
+    {
+    public:
+        explicit queue_guard(LockType& lock)
+          : lock_(lock)
+        {
+            lock_.lock(node_);
+        }
+
+        LOCKS_NON_COPYABLE(queue_guard);
+
+        ~queue_guard()
+        {
+            lock_.unlock(node_);
+        }
+
+    private:
+        LockType& lock_;
+        typename LockType::node_type node_;
+    };
+
+}    // namespace locks
@@ -0,0 +1,188 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+#include <util/node_cache.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace locks {
+
+    // MCS queue lock whose waiters spin for SpinCount polls and then suspend
+    // their thread. unlock() hands the lock directly to its successor and
+    // resumes exactly that thread, so a parked waiter costs no CPU time and
+    // waking it up is O(1).
+    template <std::size_t SpinCount = 128,
+        typename LayoutPolicy = policy::compact>
+    class basic_Parking_lock
+    {
+        using state_type = std::atomic<std::uint32_t>;
+
+    public:
+        // Queue node for callers that want to provide their own storage,
+        // e.g. on the stack. The node must stay alive until unlock(node)
+        // returns.
+        struct park_node
+        {
+            alignas(policy::layout_alignment_v<LayoutPolicy, state_type>)
+                state_type state{0};
+            std::atomic<park_node*> next{nullptr};
+            platform::thread_handle thread_id{};
+        };
+
+        using node_type = park_node;
+
+        basic_Parking_lock() = default;
+        LOCKS_NON_COPYABLE(basic_Parking_lock);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+        void lock(park_node& node);
+        bool try_lock(park_node& node);
+        void unlock(park_node& node);
+
+    private:
+        // park_node::state values
+        static constexpr std::uint32_t waiting = 0;
+        static constexpr std::uint32_t parked = 1;
+        static constexpr std::uint32_t granted = 2;
+
+        static void wait_for_grant(park_node& node);
+
+        alignas(policy::layout_alignment_v<LayoutPolicy, std::atomic<void*>>)
+            std::atomic<park_node*> tail{nullptr};
+    };
+
+    template <std::size_t SpinCount, typename LayoutPolicy>
+    inline void basic_Parking_lock<SpinCount, LayoutPolicy>::wait_for_grant(
+        park_node& node)
+    {
+        for (std::size_t k = 0; k != SpinCount; ++k)
+        {
+            if (node.state.load(std::memory_order_acquire) == granted)
+                return;
+
+            platform::pause();
+        }
+
+        // Publish who we are before announcing that we are going to sleep,
+        // the predecessor resumes us only if it sees the parked state.
+        node.thread_id = platform::self();
+
+        std::uint32_t expected = waiting;
+        if (!node.state.compare_exchange_strong(
+                expected, parked, std::memory_order_acq_rel))
+        {
+            return;    // granted in the meantime
+        }
+
+        // Suspend at least once even if the lock has been granted by now:
+        // the predecessor resumes us either way and must be able to rely on
+        // our node staying alive until then. The platform keeps a resume
+        // request that arrives before the thread actually parked.
+        do
+        {
+            platform::park("locks::Parking_lock::lock");
+        } while (node.state.load(std::memory_order_acquire) != granted);
+    }
+
+    template <std::size_t SpinCount, typename LayoutPolicy>
+    inline void basic_Parking_lock<SpinCount, LayoutPolicy>::lock(
+        park_node& node)
+    {
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.state.store(waiting, std::memory_order_relaxed);
+
+        park_node* const prev_node =
+            tail.exchange(&node, std::memory_order_acq_rel);
+
+        if (prev_node != nullptr)
+        {
+            prev_node->next.store(&node, std::memory_order_release);
+            wait_for_grant(node);
+        }
+    }
+
+    template <std::size_t SpinCount, typename LayoutPolicy>
+    inline bool basic_Parking_lock<SpinCount, LayoutPolicy>::try_lock(
+        park_node& node)
+    {
+        node.next.store(nullptr, std::memory_order_relaxed);
+        node.state.store(waiting, std::memory_order_relaxed);
+
+        park_node* expected = nullptr;
+        return tail.compare_exchange_strong(expected, &node,
+            std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+
+    template <std::size_t SpinCount, typename LayoutPolicy>
+    inline void basic_Parking_lock<SpinCount, LayoutPolicy>::unlock(
+        park_node& node)
+    {
+        park_node* next = node.next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            park_node* p = &node;
+            if (tail.compare_exchange_strong(p, nullptr,
+                    std::memory_order_release, std::memory_order_relaxed))
+                return;
+
+            // The successor is in the middle of linking itself in
+            while ((next = node.next.load(std::memory_order_acquire)) ==
+                nullptr)
+            {
+                platform::pause();
+            }
+        }
+
+        // A parked successor does not leave before we resumed it, its node
+        // is safe to read after the exchange.
+        if (next->state.exchange(granted, std::memory_order_acq_rel) == parked)
+        {
+            platform::unpark(next->thread_id);
+        }
+    }
+
+    template <std::size_t SpinCount, typename LayoutPolicy>
+    inline void basic_Parking_lock<SpinCount, LayoutPolicy>::lock()
+    {
+        park_node* local_node = util::node_cache<park_node>::acquire();
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
+
+        lock(*local_node);
+    }
+
+    template <std::size_t SpinCount, typename LayoutPolicy>
+    inline bool basic_Parking_lock<SpinCount, LayoutPolicy>::try_lock()
+    {
+        park_node* local_node = util::node_cache<park_node>::acquire();
+        if (!try_lock(*local_node))
+        {
+            util::node_cache<park_node>::release(local_node);
+            return false;
+        }
+
+        platform::set_thread_data(reinterpret_cast<std::size_t>(local_node));
+
+        return true;
+    }
+
+    template <std::size_t SpinCount, typename LayoutPolicy>
+    inline void basic_Parking_lock<SpinCount, LayoutPolicy>::unlock()
+    {
+        park_node* const curr_node =
+            reinterpret_cast<park_node*>(platform::get_thread_data());
+
+        unlock(*curr_node);
+        util::node_cache<park_node>::release(curr_node);
+    }
+
+    using Parking_lock = basic_Parking_lock<>;
+
+}    // namespace locks
@@ -0,0 +1,14 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/partitioned-ticket.hpp>
+
+namespace locks {
+
+    // Partitioned ticket lock with backoff proportional to the number of
+    // waiters ahead.
+    using Partitioned_ticket_BO_lock =
+        basic_Partitioned_ticket_lock<policy::proportional<>>;
+
+}    // namespace locks
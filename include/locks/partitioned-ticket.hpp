@@ -0,0 +1,115 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace locks {
+
+    // Ticket lock spreading its waiters over Slots grant slots, each on its
+    // own cache line. Ticket t waits on slot t % Slots, so a release only
+    // invalidates the line the next ticket holder is polling instead of the
+    // line every waiter is polling.
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact, std::size_t Slots = 8>
+    class basic_Partitioned_ticket_lock
+    {
+        static_assert(Slots != 0 && (Slots & (Slots - 1)) == 0,
+            "the number of grant slots must be a power of two");
+
+    public:
+        basic_Partitioned_ticket_lock() = default;
+        LOCKS_NON_COPYABLE(basic_Partitioned_ticket_lock);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+        bool is_locked();
+
+    private:
+        using ticket_type = std::uint64_t;
+
+        static constexpr std::size_t alignment =
+            policy::layout_alignment_v<LayoutPolicy, std::atomic<ticket_type>>;
+
+        struct alignas(policy::cache_line_size) grant_slot
+        {
+            std::atomic<ticket_type> grant{0};
+        };
+
+        alignas(alignment) std::atomic<ticket_type> next_ticket{0};
+
+        // Written by every new lock holder, read by waiters to estimate
+        // their distance to the head of the queue
+        alignas(alignment) std::atomic<ticket_type> owner_ticket{0};
+
+        grant_slot grants[Slots];
+    };
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline void basic_Partitioned_ticket_lock<WaitPolicy, LayoutPolicy,
+        Slots>::lock()
+    {
+        ticket_type const ticket =
+            next_ticket.fetch_add(1, std::memory_order_relaxed);
+        std::atomic<ticket_type>& grant = grants[ticket % Slots].grant;
+
+        policy::wait_for_turn<WaitPolicy>(
+            [this, ticket, &grant]() -> std::size_t {
+                if (grant.load(std::memory_order_acquire) == ticket)
+                    return 0;
+
+                ticket_type const owner =
+                    owner_ticket.load(std::memory_order_relaxed);
+                return ticket > owner ? ticket - owner : 1;
+            },
+            "locks::Partitioned_ticket_lock::lock");
+
+        owner_ticket.store(ticket, std::memory_order_relaxed);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline bool basic_Partitioned_ticket_lock<WaitPolicy, LayoutPolicy,
+        Slots>::try_lock()
+    {
+        // Draw the next ticket only if it has already been granted
+        ticket_type ticket = next_ticket.load(std::memory_order_relaxed);
+        if (grants[ticket % Slots].grant.load(std::memory_order_acquire) !=
+                ticket ||
+            !next_ticket.compare_exchange_strong(ticket, ticket + 1,
+                std::memory_order_relaxed, std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        owner_ticket.store(ticket, std::memory_order_relaxed);
+        return true;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline void basic_Partitioned_ticket_lock<WaitPolicy, LayoutPolicy,
+        Slots>::unlock()
+    {
+        ticket_type const next =
+            owner_ticket.load(std::memory_order_relaxed) + 1;
+        grants[next % Slots].grant.store(next, std::memory_order_release);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy, std::size_t Slots>
+    inline bool basic_Partitioned_ticket_lock<WaitPolicy, LayoutPolicy,
+        Slots>::is_locked()
+    {
+        ticket_type const next = next_ticket.load(std::memory_order_acquire);
+        return grants[next % Slots].grant.load(std::memory_order_acquire) !=
+            next;
+    }
+
+    using Partitioned_ticket_lock =
+        basic_Partitioned_ticket_lock<policy::pause>;
+
+}    // namespace locks
@@ -0,0 +1,151 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace locks {
+
+    // Phase-fair ticket reader-writer lock (Brandenburg and Anderson). Read
+    // and write phases alternate whenever both are waiting: a writer waits
+    // for at most one read phase and a reader for at most one write phase.
+    // Writers are served in FIFO order among themselves.
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact>
+    class basic_Phase_fair_RW_lock
+    {
+    public:
+        basic_Phase_fair_RW_lock() = default;
+        LOCKS_NON_COPYABLE(basic_Phase_fair_RW_lock);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+        void lock_shared();
+        bool try_lock_shared();
+        void unlock_shared();
+
+    private:
+        // The reader counters advance in steps of reader_inc, the low bits
+        // of reader_in tell readers whether a writer is present and which
+        // phase it belongs to.
+        static constexpr std::uint32_t reader_inc = 0x100;
+        static constexpr std::uint32_t writer_bits = 0x3;
+        static constexpr std::uint32_t writer_present = 0x2;
+        static constexpr std::uint32_t phase_id = 0x1;
+
+        static constexpr std::size_t alignment = policy::layout_alignment_v<
+            LayoutPolicy, std::atomic<std::uint32_t>>;
+
+        alignas(alignment) std::atomic<std::uint32_t> reader_in{0};
+        alignas(alignment) std::atomic<std::uint32_t> reader_out{0};
+        alignas(alignment) std::atomic<std::uint32_t> writer_in{0};
+        alignas(alignment) std::atomic<std::uint32_t> writer_out{0};
+    };
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_Phase_fair_RW_lock<WaitPolicy, LayoutPolicy>::lock()
+    {
+        // Wait for the previous writers
+        std::uint32_t const ticket =
+            writer_in.fetch_add(1, std::memory_order_relaxed);
+        WaitPolicy::wait_while(
+            [this, ticket] {
+                return writer_out.load(std::memory_order_acquire) != ticket;
+            },
+            "locks::Phase_fair_RW_lock::lock");
+
+        // Block new readers and wait for the ones already inside
+        std::uint32_t const readers = reader_in.fetch_add(
+            writer_present | (ticket & phase_id), std::memory_order_acq_rel);
+        WaitPolicy::wait_while(
+            [this, readers] {
+                return reader_out.load(std::memory_order_acquire) != readers;
+            },
+            "locks::Phase_fair_RW_lock::lock");
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_Phase_fair_RW_lock<WaitPolicy, LayoutPolicy>::try_lock()
+    {
+        // Take the next writer ticket only if no writer holds or waits for
+        // the lock
+        std::uint32_t ticket = writer_in.load(std::memory_order_relaxed);
+        if (writer_out.load(std::memory_order_acquire) != ticket ||
+            !writer_in.compare_exchange_strong(ticket, ticket + 1,
+                std::memory_order_relaxed, std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        // Enter only if no reader is inside, otherwise pass the ticket on
+        std::uint32_t readers = reader_in.load(std::memory_order_relaxed);
+        if (reader_out.load(std::memory_order_acquire) == readers &&
+            reader_in.compare_exchange_strong(readers,
+                readers | writer_present | (ticket & phase_id),
+                std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            return true;
+        }
+
+        writer_out.fetch_add(1, std::memory_order_release);
+        return false;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_Phase_fair_RW_lock<WaitPolicy, LayoutPolicy>::unlock()
+    {
+        reader_in.fetch_and(~writer_bits, std::memory_order_release);
+        writer_out.fetch_add(1, std::memory_order_release);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void
+    basic_Phase_fair_RW_lock<WaitPolicy, LayoutPolicy>::lock_shared()
+    {
+        std::uint32_t const writer =
+            reader_in.fetch_add(reader_inc, std::memory_order_acquire) &
+            writer_bits;
+
+        // Wait for the current write phase to end
+        if (writer != 0)
+        {
+            WaitPolicy::wait_while(
+                [this, writer] {
+                    return (reader_in.load(std::memory_order_acquire) &
+                               writer_bits) == writer;
+                },
+                "locks::Phase_fair_RW_lock::lock_shared");
+        }
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool
+    basic_Phase_fair_RW_lock<WaitPolicy, LayoutPolicy>::try_lock_shared()
+    {
+        std::uint32_t readers = reader_in.load(std::memory_order_relaxed);
+        while ((readers & writer_bits) == 0)
+        {
+            if (reader_in.compare_exchange_weak(readers, readers + reader_inc,
+                    std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+
+        return false;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void
+    basic_Phase_fair_RW_lock<WaitPolicy, LayoutPolicy>::unlock_shared()
+    {
+        reader_out.fetch_add(reader_inc, std::memory_order_release);
+    }
+
+    using Phase_fair_RW_lock = basic_Phase_fair_RW_lock<policy::pause>;
+
+}    // namespace locks
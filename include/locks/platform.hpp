@@ -0,0 +1,520 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+// The locks run on top of HPX threads unless LOCKS_WITH_HPX is defined to 0,
+// in which case they only need C++17 and plain std::thread. Everything the
+// locks need from the runtime goes through locks::platform.
+#if !defined(LOCKS_WITH_HPX)
+#define LOCKS_WITH_HPX 1
+#endif
+
+#if LOCKS_WITH_HPX
+#include <hpx/chrono.hpp>
+#include <hpx/config.hpp>
+#include <hpx/hpx_finalize.hpp>
+#include <hpx/modules/async_local.hpp>
+#include <hpx/modules/executors.hpp>
+#include <hpx/modules/futures.hpp>
+#include <hpx/modules/runtime_local.hpp>
+#include <hpx/modules/threading.hpp>
+#include <hpx/version.hpp>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#else
+#include <chrono>
+#include <future>
+#include <mutex>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if LOCKS_WITH_HPX
+#define LOCKS_NON_COPYABLE(cls) HPX_NON_COPYABLE(cls)
+#define LOCKS_NOINLINE HPX_NOINLINE
+#else
+#define LOCKS_NON_COPYABLE(cls)                                                \
+    cls(cls const&) = delete;                                                  \
+    cls(cls&&) = delete;                                                       \
+    cls& operator=(cls const&) = delete;                                       \
+    cls& operator=(cls&&) = delete
+
+#if defined(_MSC_VER)
+#define LOCKS_NOINLINE __declspec(noinline)
+#else
+#define LOCKS_NOINLINE __attribute__((noinline))
+#endif
+#endif
+
+namespace locks { namespace platform {
+
+#if LOCKS_WITH_HPX
+    ////////////////////////////////////////////////////////////////////////////
+    // HPX backend. Threads are HPX threads, workers are the HPX worker
+    // threads.
+
+    inline constexpr char const* runtime_name = "hpx";
+
+    inline std::string runtime_version()
+    {
+        return hpx::full_version_as_string();
+    }
+
+    // SMT pause hint for spin loops
+    inline void pause()
+    {
+        HPX_SMT_PAUSE;
+    }
+
+    inline void yield()
+    {
+        hpx::this_thread::yield();
+    }
+
+    // Gives up the core so that e.g. a descheduled lock holder can run
+    inline void suspend()
+    {
+        hpx::this_thread::suspend();
+    }
+
+    template <typename Predicate>
+    void yield_while(Predicate&& pred, char const* desc)
+    {
+        hpx::util::yield_while(pred, desc);
+    }
+
+    // Number of worker threads, usable before the runtime started
+    inline std::size_t thread_count()
+    {
+        return hpx::is_running() ? hpx::get_os_thread_count() :
+                                   std::thread::hardware_concurrency();
+    }
+
+    // Index of the calling worker thread, thread_count() or above for
+    // threads that are no workers
+    inline std::size_t thread_index()
+    {
+        return hpx::get_worker_thread_num();
+    }
+
+    // Word of storage per thread, e.g. for the queue node of the lock the
+    // thread holds. Follows the HPX thread across workers.
+    inline std::size_t get_thread_data()
+    {
+        return hpx::threads::get_thread_data(hpx::threads::get_self_id());
+    }
+
+    inline void set_thread_data(std::size_t data)
+    {
+        hpx::threads::set_thread_data(hpx::threads::get_self_id(), data);
+    }
+
+    // Monotonic time in nanoseconds
+    inline std::uint64_t now()
+    {
+        return hpx::chrono::high_resolution_clock::now();
+    }
+
+    // Measures the seconds since its construction
+    using timer = hpx::chrono::high_resolution_timer;
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Parking suspends the calling thread until another thread unparks it.
+    // An unpark that arrives before the thread parked is not lost.
+    using thread_handle = hpx::threads::thread_id_type;
+
+    inline thread_handle self()
+    {
+        return hpx::threads::get_self_id();
+    }
+
+    inline void park(char const* desc)
+    {
+        hpx::this_thread::suspend(
+            hpx::threads::thread_schedule_state::suspended, desc);
+    }
+
+    // Takes the handle by value like the std backend: once the thread runs
+    // again it may reuse wherever the handle was kept
+    inline void unpark(thread_handle thread)
+    {
+        hpx::threads::set_thread_state(
+            thread, hpx::threads::thread_schedule_state::pending);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    using future = hpx::future<T>;
+
+    template <typename T>
+    using promise = hpx::lcos::local::promise<T>;
+
+    // Runs f on its own thread pinned to the given worker
+    template <typename F>
+    future<void> run_on_worker(std::size_t worker, F&& f)
+    {
+        // Bound threads are never stolen by other workers
+        hpx::execution::parallel_executor exec(
+            hpx::threads::thread_priority::bound,
+            hpx::threads::thread_stacksize::default_,
+            hpx::threads::thread_schedule_hint(
+                static_cast<std::int16_t>(worker)));
+
+        return hpx::async(exec, std::forward<F>(f));
+    }
+
+    namespace detail {
+
+        // CPU every worker thread is bound to, probed once. HPX binds the
+        // workers itself, see --hpx:bind.
+        inline std::vector<std::size_t> const& worker_cpus()
+        {
+            static std::vector<std::size_t> const cpus = [] {
+                std::vector<std::size_t> result(
+                    thread_count(), ~std::size_t(0));
+#if defined(__linux__)
+                for (std::size_t w = 0; w != result.size(); ++w)
+                {
+                    run_on_worker(w, [&result, w] {
+                        int const cpu = sched_getcpu();
+                        if (cpu >= 0)
+                            result[w] = static_cast<std::size_t>(cpu);
+                    }).get();
+                }
+#endif
+                return result;
+            }();
+            return cpus;
+        }
+    }    // namespace detail
+
+    // Whether run_on_cpu() can place a thread on cpu
+    inline bool can_run_on_cpu(std::size_t cpu)
+    {
+        auto const& cpus = detail::worker_cpus();
+        return std::find(cpus.begin(), cpus.end(), cpu) != cpus.end();
+    }
+
+    // Runs f on the worker bound to cpu, which must satisfy
+    // can_run_on_cpu(). Threads placed on the same CPU share its worker
+    // and only take turns when they yield.
+    template <typename F>
+    future<void> run_on_cpu(std::size_t cpu, F&& f)
+    {
+        auto const& cpus = detail::worker_cpus();
+        std::size_t const worker = static_cast<std::size_t>(
+            std::find(cpus.begin(), cpus.end(), cpu) - cpus.begin());
+        return run_on_worker(worker, std::forward<F>(f));
+    }
+
+    // Runs f during finalize()
+    inline void at_shutdown(std::function<void()> f)
+    {
+        hpx::register_shutdown_function(std::move(f));
+    }
+
+    // Shuts the runtime down at the end of the main function of the
+    // application
+    inline int finalize()
+    {
+        return hpx::finalize();
+    }
+
+#else
+    ////////////////////////////////////////////////////////////////////////////
+    // std::thread backend. Every std::thread is a worker, parking uses a
+    // futex on Linux.
+
+    inline constexpr char const* runtime_name = "std";
+
+    inline std::string runtime_version()
+    {
+        return "";
+    }
+
+    inline void pause()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#endif
+    }
+
+    inline void yield()
+    {
+        std::this_thread::yield();
+    }
+
+    inline void suspend()
+    {
+        std::this_thread::yield();
+    }
+
+    template <typename Predicate>
+    void yield_while(Predicate&& pred, char const* /* desc */)
+    {
+        while (pred())
+            std::this_thread::yield();
+    }
+
+    namespace detail {
+
+        inline std::size_t& thread_count_slot()
+        {
+            static std::size_t count =
+                std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+            return count;
+        }
+    }    // namespace detail
+
+    // Number of worker threads, the hardware threads unless changed with
+    // set_thread_count()
+    inline std::size_t thread_count()
+    {
+        return detail::thread_count_slot();
+    }
+
+    // Change before creating locks, they size per-worker state by it
+    inline void set_thread_count(std::size_t count)
+    {
+        detail::thread_count_slot() = std::max<std::size_t>(count, 1);
+    }
+
+    namespace detail {
+
+        // Every live thread holds the lowest index no other live thread
+        // holds, so the indices stay below the number of threads even if
+        // the benchmarks start new threads for every run
+        class thread_index_holder
+        {
+        public:
+            thread_index_holder()
+            {
+                std::lock_guard<std::mutex> guard(mtx());
+                std::vector<bool>& used = indices();
+                index = std::find(used.begin(), used.end(), false) -
+                    used.begin();
+                if (index == used.size())
+                    used.push_back(true);
+                else
+                    used[index] = true;
+            }
+
+            ~thread_index_holder()
+            {
+                std::lock_guard<std::mutex> guard(mtx());
+                indices()[index] = false;
+            }
+
+            std::size_t index;
+
+        private:
+            static std::mutex& mtx()
+            {
+                static std::mutex m;
+                return m;
+            }
+
+            static std::vector<bool>& indices()
+            {
+                static std::vector<bool> used;
+                return used;
+            }
+        };
+
+        LOCKS_NOINLINE inline std::size_t thread_index_slot()
+        {
+            static thread_local thread_index_holder holder;
+            return holder.index;
+        }
+
+        LOCKS_NOINLINE inline std::size_t& thread_data_slot()
+        {
+            static thread_local std::size_t data = 0;
+            return data;
+        }
+
+        struct park_slot
+        {
+            // 1 while an unpark is pending
+            std::atomic<std::uint32_t> permit{0};
+        };
+
+        LOCKS_NOINLINE inline park_slot& current_park_slot()
+        {
+            static thread_local park_slot slot;
+            return slot;
+        }
+    }    // namespace detail
+
+    inline std::size_t thread_index()
+    {
+        return detail::thread_index_slot();
+    }
+
+    inline std::size_t get_thread_data()
+    {
+        return detail::thread_data_slot();
+    }
+
+    inline void set_thread_data(std::size_t data)
+    {
+        detail::thread_data_slot() = data;
+    }
+
+    inline std::uint64_t now()
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+
+    class timer
+    {
+    public:
+        double elapsed() const
+        {
+            return static_cast<double>(now() - start) * 1e-9;
+        }
+
+        void restart()
+        {
+            start = now();
+        }
+
+    private:
+        std::uint64_t start{now()};
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    using thread_handle = detail::park_slot*;
+
+    inline thread_handle self()
+    {
+        return &detail::current_park_slot();
+    }
+
+    inline void park(char const* /* desc */)
+    {
+        std::atomic<std::uint32_t>& permit = detail::current_park_slot().permit;
+        while (permit.exchange(0, std::memory_order_acquire) == 0)
+        {
+#if defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&permit),
+                FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+#else
+            std::this_thread::yield();
+#endif
+        }
+    }
+
+    // Takes the handle by value: once the permit is stored the parked
+    // thread may run off and reuse wherever the handle was kept
+    inline void unpark(thread_handle thread)
+    {
+        thread->permit.store(1, std::memory_order_release);
+#if defined(__linux__)
+        // Waking an address whose thread already left is harmless
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&thread->permit),
+            FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    using future = std::future<T>;
+
+    template <typename T>
+    using promise = std::promise<T>;
+
+    // Plain threads cannot be pinned to a worker, f gets a thread of its
+    // own instead
+    template <typename F>
+    future<void> run_on_worker(std::size_t /* worker */, F&& f)
+    {
+        return std::async(std::launch::async, std::forward<F>(f));
+    }
+
+    // Whether run_on_cpu() can place a thread on cpu: the process must be
+    // allowed to run there
+    inline bool can_run_on_cpu(std::size_t cpu)
+    {
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (cpu >= CPU_SETSIZE ||
+            sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        {
+            return false;
+        }
+        return CPU_ISSET(cpu, &allowed);
+#else
+        return false;
+#endif
+    }
+
+    // Runs f on a thread of its own pinned to cpu, which must satisfy
+    // can_run_on_cpu()
+    template <typename F>
+    future<void> run_on_cpu(std::size_t cpu, F&& f)
+    {
+        return std::async(
+            std::launch::async, [cpu, f = std::forward<F>(f)]() mutable {
+#if defined(__linux__)
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+                f();
+            });
+    }
+
+    namespace detail {
+
+        inline std::vector<std::function<void()>>& shutdown_functions()
+        {
+            static std::vector<std::function<void()>> functions;
+            return functions;
+        }
+    }    // namespace detail
+
+    inline void at_shutdown(std::function<void()> f)
+    {
+        detail::shutdown_functions().push_back(std::move(f));
+    }
+
+    // Runs the functions registered with at_shutdown(). Must not be called
+    // while other threads are still running.
+    inline int finalize()
+    {
+        std::vector<std::function<void()>> functions;
+        functions.swap(detail::shutdown_functions());
+        for (auto& f : functions)
+            f();
+        return 0;
+    }
+#endif
+
+}}    // namespace locks::platform
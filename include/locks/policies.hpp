@@ -0,0 +1,255 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <util/backoff.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace locks { namespace policy {
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Wait policies decide what a lock does while the condition it is waiting
+    // on still holds. Every policy exposes
+    //
+    //     template <typename Predicate>
+    //     static void wait_while(Predicate&& pred, char const* desc);
+    //
+    // which returns once pred() evaluated to false.
+
+    namespace detail {
+
+        // Number of times policy::counting found the condition still
+        // holding on the calling worker thread, read by locks::instrumented.
+        // HPX threads may be resumed on a different worker, never let the
+        // compiler reuse a thread-local address across a suspension point.
+        LOCKS_NOINLINE inline std::uint64_t& worker_polls()
+        {
+            static thread_local std::uint64_t polls = 0;
+            return polls;
+        }
+
+        // Counts the polls of one wait_while() call and adds them to
+        // worker_polls() when the call returns
+        class poll_counter
+        {
+        public:
+            poll_counter() = default;
+            LOCKS_NON_COPYABLE(poll_counter);
+
+            ~poll_counter()
+            {
+                if (polls != 0)
+                    worker_polls() += polls;
+            }
+
+            void operator++()
+            {
+                ++polls;
+            }
+
+        private:
+            std::uint64_t polls{0};
+        };
+    }    // namespace detail
+
+    // Busy-wait on the core, only issuing the SMT pause hint.
+    struct pause
+    {
+        template <typename Predicate>
+        static void wait_while(Predicate&& pred, char const* /* desc */)
+        {
+            while (pred())
+            {
+                platform::pause();
+            }
+        }
+    };
+
+    // Bounded exponential backoff with jitter between two polls, tuned
+    // through util::backoff_config().
+    struct backoff
+    {
+        template <typename Predicate>
+        static void wait_while(Predicate&& pred, char const* /* desc */)
+        {
+            util::exponential_backoff backoff;
+            while (pred())
+            {
+                backoff();
+            }
+        }
+    };
+
+    // Let the scheduler run other work while waiting.
+    struct yield
+    {
+        template <typename Predicate>
+        static void wait_while(Predicate&& pred, char const* desc)
+        {
+            platform::yield_while(pred, desc);
+        }
+    };
+
+    // Spin for a bounded number of polls, then suspend the thread
+    // between polls so long waits stop occupying a worker.
+    template <std::size_t SpinCount = 128>
+    struct spin_suspend
+    {
+        template <typename Predicate>
+        static void wait_while(Predicate&& pred, char const* /* desc */)
+        {
+            for (std::size_t k = 0; pred(); ++k)
+            {
+                if (k < SpinCount)
+                    platform::pause();
+                else
+                    platform::suspend();
+            }
+        }
+    };
+
+    // Queue-ordered locks (e.g. the ticket locks) know how many waiters are
+    // ahead of them, wait for a time proportional to that distance instead
+    // of polling the shared state in a tight loop.
+    template <std::size_t DelayPerWaiter = 64>
+    struct proportional
+    {
+        template <typename Distance>
+        static void wait_for_turn(Distance&& distance, char const* /* desc */)
+        {
+            for (std::size_t ahead = distance(); ahead != 0;
+                 ahead = distance())
+            {
+                for (std::size_t i = 0; i != ahead * DelayPerWaiter; ++i)
+                {
+                    platform::pause();
+                }
+            }
+        }
+
+        template <typename Predicate>
+        static void wait_while(Predicate&& pred, char const* /* desc */)
+        {
+            while (pred())
+            {
+                platform::pause();
+            }
+        }
+    };
+
+    namespace detail {
+
+        template <typename WaitPolicy, typename Enable = void>
+        struct has_wait_for_turn : std::false_type
+        {
+        };
+
+        template <typename WaitPolicy>
+        struct has_wait_for_turn<WaitPolicy,
+            std::void_t<decltype(WaitPolicy::wait_for_turn(
+                std::declval<std::size_t (*)()>(), nullptr))>>
+          : std::true_type
+        {
+        };
+    }    // namespace detail
+
+    // Waits until distance() returns 0, distance() being the number of
+    // waiters ahead of the caller. Policies without a notion of distance just
+    // poll it through wait_while.
+    template <typename WaitPolicy, typename Distance>
+    void wait_for_turn(Distance&& distance, char const* desc)
+    {
+        if constexpr (detail::has_wait_for_turn<WaitPolicy>::value)
+        {
+            WaitPolicy::wait_for_turn(distance, desc);
+        }
+        else
+        {
+            WaitPolicy::wait_while(
+                [&distance] { return distance() != 0; }, desc);
+        }
+    }
+
+    // Waits through WaitPolicy and counts the polls that found the condition
+    // still holding into detail::worker_polls(). locks::instrumented makes
+    // the lock it wraps wait through it, all other locks never pay for the
+    // counting.
+    template <typename WaitPolicy>
+    struct counting
+    {
+        template <typename Predicate>
+        static void wait_while(Predicate&& pred, char const* desc)
+        {
+            detail::poll_counter counter;
+            WaitPolicy::wait_while(
+                [&] {
+                    if (!pred())
+                        return false;
+                    ++counter;
+                    return true;
+                },
+                desc);
+        }
+
+        template <typename Distance>
+        static void wait_for_turn(Distance&& distance, char const* desc)
+        {
+            detail::poll_counter counter;
+            policy::wait_for_turn<WaitPolicy>(
+                [&] {
+                    auto const ahead = distance();
+                    if (ahead != 0)
+                        ++counter;
+                    return ahead;
+                },
+                desc);
+        }
+    };
+
+    namespace detail {
+
+        template <typename T, typename Enable = void>
+        struct is_wait_policy : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct is_wait_policy<T,
+            std::void_t<decltype(
+                T::wait_while(std::declval<bool (*)()>(), nullptr))>>
+          : std::true_type
+        {
+        };
+    }    // namespace detail
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Layout policies decide how the lock word and the queue nodes are placed
+    // in memory. Locks align their shared state to
+    // layout_alignment_v<LayoutPolicy, T>.
+
+    constexpr std::size_t cache_line_size = 64;
+
+    // Natural alignment, smallest footprint.
+    struct compact
+    {
+        static constexpr std::size_t alignment = 1;
+    };
+
+    // Align and pad to a full cache line so that neighbouring locks and
+    // nodes never share one.
+    struct padded
+    {
+        static constexpr std::size_t alignment = cache_line_size;
+    };
+
+    template <typename LayoutPolicy, typename T>
+    inline constexpr std::size_t layout_alignment_v =
+        LayoutPolicy::alignment > alignof(T) ? LayoutPolicy::alignment :
+                                               alignof(T);
+
+}}    // namespace locks::policy
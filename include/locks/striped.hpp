@@ -0,0 +1,131 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/node-lock.hpp>
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace locks {
+
+    // N instances of LockType, each on a cache line of its own, picked by
+    // hashing a key. Keys on different stripes can be locked concurrently,
+    // e.g. the buckets of a hash table. The stripes of several keys are
+    // always acquired in ascending stripe order, so threads locking
+    // overlapping sets of keys cannot deadlock.
+    template <typename LockType, std::size_t N>
+    class striped_lock
+    {
+        static_assert(N != 0, "striped_lock needs at least one stripe");
+
+    public:
+        static constexpr std::size_t stripes = N;
+
+        // Holds the stripes of up to K keys until destroyed, every stripe
+        // only once. Queue locks (MCS_lock, CLH_lock, Parking_lock, ...) are
+        // acquired through nodes kept in the guard, so a thread can hold
+        // several of their stripes at once.
+        template <std::size_t K>
+        class guard
+        {
+        public:
+            guard(striped_lock& locks, std::array<std::size_t, K> stripes);
+
+            LOCKS_NON_COPYABLE(guard);
+
+            ~guard();
+
+        private:
+            using node_type = typename detail::node_type_of<LockType>::type;
+
+            striped_lock& locks_;
+            std::array<std::size_t, K> stripes_;
+            std::size_t count_{0};
+            std::array<node_type, K> nodes_{};
+        };
+
+        striped_lock() = default;
+        LOCKS_NON_COPYABLE(striped_lock);
+
+        template <typename Key>
+        static std::size_t stripe_of(Key const& key);
+
+        LockType& stripe(std::size_t index)
+        {
+            return locks_[index].lock;
+        }
+
+        // The stripe of key, e.g. for std::lock_guard
+        template <typename Key>
+        LockType& lock_for(Key const& key)
+        {
+            return stripe(stripe_of(key));
+        }
+
+        template <typename... Keys>
+        guard<sizeof...(Keys)> lock_keys(Keys const&... keys)
+        {
+            return guard<sizeof...(Keys)>(*this, {stripe_of(keys)...});
+        }
+
+    private:
+        struct alignas(policy::cache_line_size) padded_lock
+        {
+            LockType lock;
+        };
+
+        std::array<padded_lock, N> locks_;
+    };
+
+    template <typename LockType, std::size_t N>
+    template <typename Key>
+    inline std::size_t striped_lock<LockType, N>::stripe_of(Key const& key)
+    {
+        // std::hash is the identity for integers in the common standard
+        // libraries. Fibonacci hashing spreads consecutive keys over all
+        // stripes.
+        std::uint64_t const hash = std::hash<Key>{}(key);
+        return static_cast<std::size_t>(
+            ((hash * 0x9e3779b97f4a7c15ull) >> 32) % N);
+    }
+
+    template <typename LockType, std::size_t N>
+    template <std::size_t K>
+    inline striped_lock<LockType, N>::guard<K>::guard(
+        striped_lock& locks, std::array<std::size_t, K> stripes)
+      : locks_(locks)
+      , stripes_(stripes)
+    {
+        std::sort(stripes_.begin(), stripes_.end());
+        count_ = static_cast<std::size_t>(
+            std::unique(stripes_.begin(), stripes_.end()) - stripes_.begin());
+
+        for (std::size_t i = 0; i != count_; ++i)
+        {
+            if constexpr (detail::has_node_type_v<LockType>)
+                locks_.stripe(stripes_[i]).lock(nodes_[i]);
+            else
+                locks_.stripe(stripes_[i]).lock();
+        }
+    }
+
+    template <typename LockType, std::size_t N>
+    template <std::size_t K>
+    inline striped_lock<LockType, N>::guard<K>::~guard()
+    {
+        for (std::size_t i = count_; i != 0; --i)
+        {
+            if constexpr (detail::has_node_type_v<LockType>)
+                locks_.stripe(stripes_[i - 1]).unlock(nodes_[i - 1]);
+            else
+                locks_.stripe(stripes_[i - 1]).unlock();
+        }
+    }
+
+}    // namespace locks
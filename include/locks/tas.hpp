@@ -2,45 +2,95 @@
 
 #pragma once
 
-#include <hpx/config.hpp>
-
-#include <immintrin.h>
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
 
 #include <atomic>
-#include <iostream>
+#include <chrono>
 
 namespace locks {
 
-    class TAS_lock
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact>
+    class basic_TAS_lock
     {
     public:
-        TAS_lock() = default;
-        HPX_NON_COPYABLE(TAS_lock);
+        basic_TAS_lock() = default;
+        LOCKS_NON_COPYABLE(basic_TAS_lock);
 
         void lock();
+        bool try_lock();
         void unlock();
         bool is_locked();
 
+        template <typename Rep, typename Period>
+        bool try_lock_for(std::chrono::duration<Rep, Period> const& timeout);
+
+        template <typename Clock, typename Duration>
+        bool try_lock_until(
+            std::chrono::time_point<Clock, Duration> const& deadline);
+
     private:
-        std::atomic<bool> is_locked_;
+        bool acquire_lock();
+
+        alignas(policy::layout_alignment_v<LayoutPolicy, std::atomic<bool>>)
+            std::atomic<bool> is_locked_{false};
     };
 
-    inline void TAS_lock::lock()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_TAS_lock<WaitPolicy, LayoutPolicy>::acquire_lock()
     {
-        while (is_locked_.exchange(true, std::memory_order_acquire))
-        {
-            HPX_SMT_PAUSE;
-        }
+        return !is_locked_.exchange(true, std::memory_order_acquire);
     }
 
-    inline void TAS_lock::unlock()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_TAS_lock<WaitPolicy, LayoutPolicy>::lock()
+    {
+        WaitPolicy::wait_while(
+            [this] { return !acquire_lock(); }, "locks::TAS_lock::lock");
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_TAS_lock<WaitPolicy, LayoutPolicy>::try_lock()
+    {
+        return acquire_lock();
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Rep, typename Period>
+    inline bool basic_TAS_lock<WaitPolicy, LayoutPolicy>::try_lock_for(
+        std::chrono::duration<Rep, Period> const& timeout)
+    {
+        return try_lock_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Clock, typename Duration>
+    inline bool basic_TAS_lock<WaitPolicy, LayoutPolicy>::try_lock_until(
+        std::chrono::time_point<Clock, Duration> const& deadline)
+    {
+        bool acquired = false;
+        WaitPolicy::wait_while(
+            [&] {
+                acquired = acquire_lock();
+                return !acquired && Clock::now() < deadline;
+            },
+            "locks::TAS_lock::try_lock_until");
+        return acquired;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_TAS_lock<WaitPolicy, LayoutPolicy>::unlock()
     {
         is_locked_.store(false, std::memory_order_release);
     }
 
-    inline bool TAS_lock::is_locked()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_TAS_lock<WaitPolicy, LayoutPolicy>::is_locked()
     {
         return is_locked_.load(std::memory_order_acquire);
     }
 
+    using TAS_lock = basic_TAS_lock<policy::pause>;
+
 }    // namespace locks
@@ -0,0 +1,12 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/ticket.hpp>
+
+namespace locks {
+
+    // Ticket lock with backoff proportional to the number of waiters ahead.
+    using Ticket_BO_lock = basic_Ticket_lock<policy::proportional<>>;
+
+}    // namespace locks
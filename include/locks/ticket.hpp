@@ -0,0 +1,80 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace locks {
+
+    // FIFO-fair lock without any queue nodes: every acquire draws a ticket
+    // and waits for the lock to serve it.
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact>
+    class basic_Ticket_lock
+    {
+    public:
+        basic_Ticket_lock() = default;
+        LOCKS_NON_COPYABLE(basic_Ticket_lock);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+        bool is_locked();
+
+    private:
+        using ticket_type = std::uint32_t;
+
+        static constexpr std::size_t alignment =
+            policy::layout_alignment_v<LayoutPolicy, std::atomic<ticket_type>>;
+
+        alignas(alignment) std::atomic<ticket_type> next_ticket{0};
+        alignas(alignment) std::atomic<ticket_type> now_serving{0};
+    };
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_Ticket_lock<WaitPolicy, LayoutPolicy>::lock()
+    {
+        ticket_type const ticket =
+            next_ticket.fetch_add(1, std::memory_order_relaxed);
+
+        policy::wait_for_turn<WaitPolicy>(
+            [this, ticket]() -> std::size_t {
+                return static_cast<ticket_type>(
+                    ticket - now_serving.load(std::memory_order_acquire));
+            },
+            "locks::Ticket_lock::lock");
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_Ticket_lock<WaitPolicy, LayoutPolicy>::try_lock()
+    {
+        // Draw a ticket only if it would be served right away. now_serving
+        // never passes next_ticket, so seeing both equal means the lock is
+        // free.
+        ticket_type serving = now_serving.load(std::memory_order_acquire);
+        return next_ticket.compare_exchange_strong(serving, serving + 1,
+            std::memory_order_relaxed, std::memory_order_relaxed);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_Ticket_lock<WaitPolicy, LayoutPolicy>::unlock()
+    {
+        // Only the lock holder ever writes now_serving
+        now_serving.store(now_serving.load(std::memory_order_relaxed) + 1,
+            std::memory_order_release);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_Ticket_lock<WaitPolicy, LayoutPolicy>::is_locked()
+    {
+        return next_ticket.load(std::memory_order_acquire) !=
+            now_serving.load(std::memory_order_acquire);
+    }
+
+    using Ticket_lock = basic_Ticket_lock<policy::pause>;
+
+}    // namespace locks
@@ -0,0 +1,119 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <util/trace.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace locks {
+
+    // Wraps LockType and records every request, acquisition and release
+    // through util::lock_tracer while tracing is enabled, see
+    // util::trace_config(). Without tracing it only forwards to LockType.
+    template <typename LockType>
+    class traced
+    {
+    public:
+        traced() = default;
+
+        // Shows the lock under name in the trace
+        explicit traced(std::string const& name)
+        {
+            if (util::lock_tracer::enabled())
+                util::lock_tracer::get().name_lock(this, name);
+        }
+
+        LOCKS_NON_COPYABLE(traced);
+
+        void lock();
+        bool try_lock();
+        void unlock();
+
+        // Only available if LockType supports timed acquisition
+        template <typename Rep, typename Period>
+        bool try_lock_for(std::chrono::duration<Rep, Period> const& timeout);
+
+        template <typename Clock, typename Duration>
+        bool try_lock_until(
+            std::chrono::time_point<Clock, Duration> const& deadline);
+
+    private:
+        LockType lock_;
+
+        // Only ever touched by the current lock holder
+        std::uint64_t holder_id{0};
+    };
+
+    template <typename LockType>
+    inline void traced<LockType>::lock()
+    {
+        if (!util::lock_tracer::enabled())
+        {
+            lock_.lock();
+            return;
+        }
+
+        util::lock_tracer& tracer = util::lock_tracer::get();
+        std::uint64_t const id = tracer.requested(this);
+        lock_.lock();
+        tracer.acquired(this, id);
+        holder_id = id;
+    }
+
+    template <typename LockType>
+    inline bool traced<LockType>::try_lock()
+    {
+        if (!util::lock_tracer::enabled())
+            return lock_.try_lock();
+
+        // A request that fails is left out of the trace
+        util::lock_tracer& tracer = util::lock_tracer::get();
+        std::uint64_t const id = tracer.requested(this);
+        if (!lock_.try_lock())
+            return false;
+
+        tracer.acquired(this, id);
+        holder_id = id;
+        return true;
+    }
+
+    template <typename LockType>
+    template <typename Rep, typename Period>
+    inline bool traced<LockType>::try_lock_for(
+        std::chrono::duration<Rep, Period> const& timeout)
+    {
+        return try_lock_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename LockType>
+    template <typename Clock, typename Duration>
+    inline bool traced<LockType>::try_lock_until(
+        std::chrono::time_point<Clock, Duration> const& deadline)
+    {
+        if (!util::lock_tracer::enabled())
+            return lock_.try_lock_until(deadline);
+
+        util::lock_tracer& tracer = util::lock_tracer::get();
+        std::uint64_t const id = tracer.requested(this);
+        if (!lock_.try_lock_until(deadline))
+            return false;
+
+        tracer.acquired(this, id);
+        holder_id = id;
+        return true;
+    }
+
+    template <typename LockType>
+    inline void traced<LockType>::unlock()
+    {
+        if (util::lock_tracer::enabled())
+            util::lock_tracer::get().released(this, holder_id);
+
+        lock_.unlock();
+    }
+
+}    // namespace locks
@@ -2,46 +2,92 @@
 
 #pragma once
 
-#include <hpx/config.hpp>
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
 
 #include <atomic>
+#include <chrono>
 
 namespace locks {
 
-    class TTAS_lock
+    template <typename WaitPolicy = policy::pause,
+        typename LayoutPolicy = policy::compact>
+    class basic_TTAS_lock
     {
     public:
-        TTAS_lock() = default;
-        HPX_NON_COPYABLE(TTAS_lock);
+        basic_TTAS_lock() = default;
+        LOCKS_NON_COPYABLE(basic_TTAS_lock);
 
         void lock();
+        bool try_lock();
         void unlock();
         bool is_locked();
 
+        template <typename Rep, typename Period>
+        bool try_lock_for(std::chrono::duration<Rep, Period> const& timeout);
+
+        template <typename Clock, typename Duration>
+        bool try_lock_until(
+            std::chrono::time_point<Clock, Duration> const& deadline);
+
     private:
-        std::atomic<bool> is_locked_;
+        alignas(policy::layout_alignment_v<LayoutPolicy, std::atomic<bool>>)
+            std::atomic<bool> is_locked_{false};
     };
 
-    inline void TTAS_lock::lock()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_TTAS_lock<WaitPolicy, LayoutPolicy>::lock()
     {
-        while (true)
+        do
         {
-            if (!is_locked_.load(std::memory_order_acquire) &&
-                !is_locked_.exchange(true, std::memory_order_acquire))
-                return;
+            WaitPolicy::wait_while(
+                [this] { return is_locked_.load(std::memory_order_relaxed); },
+                "locks::TTAS_lock::lock");
+        } while (is_locked_.exchange(true, std::memory_order_acquire));
+    }
 
-            HPX_SMT_PAUSE;
-        }
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_TTAS_lock<WaitPolicy, LayoutPolicy>::try_lock()
+    {
+        return !is_locked_.load(std::memory_order_relaxed) &&
+            !is_locked_.exchange(true, std::memory_order_acquire);
     }
 
-    inline void TTAS_lock::unlock()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Rep, typename Period>
+    inline bool basic_TTAS_lock<WaitPolicy, LayoutPolicy>::try_lock_for(
+        std::chrono::duration<Rep, Period> const& timeout)
+    {
+        return try_lock_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    template <typename Clock, typename Duration>
+    inline bool basic_TTAS_lock<WaitPolicy, LayoutPolicy>::try_lock_until(
+        std::chrono::time_point<Clock, Duration> const& deadline)
+    {
+        bool acquired = false;
+        WaitPolicy::wait_while(
+            [&] {
+                acquired = try_lock();
+                return !acquired && Clock::now() < deadline;
+            },
+            "locks::TTAS_lock::try_lock_until");
+        return acquired;
+    }
+
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline void basic_TTAS_lock<WaitPolicy, LayoutPolicy>::unlock()
     {
         is_locked_.store(false, std::memory_order_release);
     }
 
-    inline bool TTAS_lock::is_locked()
+    template <typename WaitPolicy, typename LayoutPolicy>
+    inline bool basic_TTAS_lock<WaitPolicy, LayoutPolicy>::is_locked()
     {
         return is_locked_.load(std::memory_order_acquire);
     }
 
+    using TTAS_lock = basic_TTAS_lock<policy::pause>;
+
 }    // namespace locks
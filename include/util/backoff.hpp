@@ -2,23 +2,133 @@
 
 #pragma once
 
-#include <hpx/config.hpp>
-#include <hpx/modules/threading.hpp>
+#include <locks/platform.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 
 namespace locks { namespace util {
 
-    inline void exp_backoff(std::size_t k)
+    ////////////////////////////////////////////////////////////////////////////
+    // Tuning knobs of exponential_backoff, delays are counted in SMT pauses.
+    // The parameters are read whenever a lock starts backing off, change them
+    // before the locks are in use (e.g. from the command line of a benchmark).
+    struct backoff_parameters
     {
-        if (k > 32)
-            hpx::this_thread::suspend();
-        else if (k > 16)
-            while (k >>= 1)
-                HPX_SMT_PAUSE;
-        else
-            while (k >>= 1)
-                ;
+        std::uint32_t min_delay{4};
+        std::uint32_t max_delay{4096};
+        double growth{2.0};
+
+        // Let every worker adjust its ceiling between min_delay and
+        // max_delay depending on how contended its recent acquires were.
+        bool adaptive{false};
+    };
+
+    inline backoff_parameters& backoff_config()
+    {
+        static backoff_parameters params;
+        return params;
     }
 
+    namespace detail {
+
+        // Worker-local state, see node_cache.hpp on why these accessors must
+        // not be inlined.
+        LOCKS_NOINLINE inline std::uint32_t& random_state()
+        {
+            static thread_local std::uint32_t state = 0;
+            return state;
+        }
+
+        LOCKS_NOINLINE inline double& adaptive_ceiling()
+        {
+            static thread_local double ceiling = backoff_config().max_delay;
+            return ceiling;
+        }
+
+        // xorshift32, good enough to decorrelate the waiters
+        inline std::uint32_t fast_random()
+        {
+            std::uint32_t& state = random_state();
+            if (state == 0)
+                state = static_cast<std::uint32_t>(
+                            reinterpret_cast<std::uintptr_t>(&state)) |
+                    1u;
+
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+    }    // namespace detail
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Bounded exponential backoff with randomized jitter. Every call waits for
+    // a random number of pauses in [min_delay, limit] and grows limit by the
+    // growth factor until it reaches the ceiling.
+    class exponential_backoff
+    {
+    public:
+        // Once waiting took that many rounds the lock holder is most likely
+        // not running, give the scheduler a chance to run it.
+        static constexpr std::size_t suspend_threshold = 32;
+
+        exponential_backoff()
+          : params(backoff_config())
+          , limit(params.min_delay)
+          , ceiling(std::max<double>(params.min_delay,
+                params.adaptive ? detail::adaptive_ceiling() :
+                                  params.max_delay))
+        {
+        }
+
+        LOCKS_NON_COPYABLE(exponential_backoff);
+
+        ~exponential_backoff()
+        {
+            if (params.adaptive && rounds != 0)
+                adapt();
+        }
+
+        void operator()()
+        {
+            std::uint32_t const span = limit - params.min_delay + 1;
+            std::uint32_t const delay =
+                params.min_delay + detail::fast_random() % span;
+
+            for (std::uint32_t i = 0; i != delay; ++i)
+            {
+                platform::pause();
+            }
+
+            double const next = limit * params.growth;
+            limit = static_cast<std::uint32_t>(
+                std::min(std::max(next, limit + 1.0), ceiling));
+
+            if (++rounds > suspend_threshold)
+                platform::suspend();
+        }
+
+    private:
+        // Raise the ceiling when we had to back off up to it, lower it when
+        // the lock was handed to us after a couple of rounds.
+        void adapt()
+        {
+            double& adaptive = detail::adaptive_ceiling();
+
+            if (limit >= ceiling)
+                adaptive = std::min(adaptive * params.growth,
+                    static_cast<double>(params.max_delay));
+            else if (rounds <= 2)
+                adaptive = std::max(adaptive / params.growth,
+                    static_cast<double>(params.min_delay));
+        }
+
+        backoff_parameters const params;
+        std::uint32_t limit;
+        double const ceiling;
+        std::size_t rounds{0};
+    };
+
 }}    // namespace locks::util
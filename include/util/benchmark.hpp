@@ -2,58 +2,957 @@
 
 #pragma once
 
-#include <hpx/chrono.hpp>
-#include <hpx/include/util.hpp>
+#include <locks/platform.hpp>
+#include <util/backoff.hpp>
+#include <util/latency.hpp>
+#include <util/topology.hpp>
+#include <util/trace.hpp>
+#include <util/work.hpp>
+#include <util/workload.hpp>
 
+#if LOCKS_WITH_HPX
+#include <hpx/hpx_init.hpp>
+#include <hpx/modules/algorithms.hpp>
+#include <hpx/modules/async_local.hpp>
+#include <hpx/modules/executors.hpp>
+#include <hpx/modules/futures.hpp>
+#include <hpx/modules/program_options.hpp>
+#include <hpx/modules/runtime_local.hpp>
+#else
+#include <boost/program_options.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace locks { namespace util {
 
+#if LOCKS_WITH_HPX
+    namespace program_options = hpx::program_options;
+#else
+    namespace program_options = boost::program_options;
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////
+    // How often benchmark_invoker runs every entry and where it writes its
+    // machine-readable reports to. Empty file names disable the report.
+    struct benchmark_parameters
+    {
+        // Untimed runs before the measurement, e.g. to warm up caches and
+        // the allocator
+        std::size_t warmup{1};
+        std::size_t repetitions{3};
+
+        std::string csv_file{};
+        std::string json_file{};
+
+        // Record wait time, bypasses and per-worker acquisitions of every
+        // critical_section(), see acquire_recorder
+        bool latency{false};
+
+        // Worker thread counts to run every entry with, in increasing order.
+        // Empty runs every entry once with all worker threads.
+        std::vector<std::size_t> sweep_threads{};
+    };
+
+    inline benchmark_parameters& benchmark_config()
+    {
+        static benchmark_parameters params;
+        return params;
+    }
+
+    inline program_options::options_description benchmark_options()
+    {
+        benchmark_parameters const defaults{};
+
+        program_options::options_description desc("Benchmark options");
+        desc.add_options()("warmup",
+            program_options::value<std::size_t>()->default_value(
+                defaults.warmup),
+            "Number of untimed runs of every entry");
+        desc.add_options()("repetitions",
+            program_options::value<std::size_t>()->default_value(
+                defaults.repetitions),
+            "Number of timed runs of every entry");
+        desc.add_options()("csv",
+            program_options::value<std::string>()->default_value(""),
+            "Append the results to this CSV file");
+        desc.add_options()("json",
+            program_options::value<std::string>()->default_value(""),
+            "Write the results to this JSON file");
+        desc.add_options()("latency",
+            "Measure the wait time of every acquisition and report its "
+            "percentiles and the fairness of the lock");
+        desc.add_options()("sweep-threads",
+            program_options::value<std::string>()->default_value(""),
+            "Run every entry with each of these worker thread counts, e.g. "
+            "1,2,4-8");
+
+        return desc;
+    }
+
+    inline void configure_benchmark(program_options::variables_map& vm)
+    {
+        benchmark_parameters& params = benchmark_config();
+        params.warmup = vm["warmup"].as<std::size_t>();
+        params.repetitions =
+            std::max<std::size_t>(vm["repetitions"].as<std::size_t>(), 1);
+        params.csv_file = vm["csv"].as<std::string>();
+        params.json_file = vm["json"].as<std::string>();
+        params.latency = vm.count("latency") != 0;
+
+        // Counts beyond the available worker threads cannot be measured
+        std::size_t const max_threads = platform::thread_count();
+        std::vector<std::size_t> threads =
+            detail::parse_sysfs_list(vm["sweep-threads"].as<std::string>());
+        threads.erase(std::remove_if(threads.begin(), threads.end(),
+                          [max_threads](std::size_t n) {
+                              return n == 0 || n > max_threads;
+                          }),
+            threads.end());
+        std::sort(threads.begin(), threads.end());
+        threads.erase(
+            std::unique(threads.begin(), threads.end()), threads.end());
+        params.sweep_threads = std::move(threads);
+    }
+
+    namespace detail {
+
+        inline std::size_t& active_workers()
+        {
+            static std::size_t workers = 0;
+            return workers;
+        }
+    }    // namespace detail
+
+    // Number of worker threads the benchmark entries currently run on
+    inline std::size_t benchmark_workers()
+    {
+        std::size_t const workers = detail::active_workers();
+        return workers != 0 ? workers : platform::thread_count();
+    }
+
+#if LOCKS_WITH_HPX
+    using benchmark_executor_type =
+        hpx::parallel::execution::restricted_thread_pool_executor;
+
+    // Executor for the tasks of a benchmark entry. During a thread sweep it
+    // keeps the tasks on the first benchmark_workers() worker threads;
+    // bound tasks are never stolen by the remaining, idle, workers.
+    inline benchmark_executor_type benchmark_executor()
+    {
+        bool const restricted = detail::active_workers() != 0;
+        return benchmark_executor_type(0, benchmark_workers(),
+            restricted ? hpx::threads::thread_priority::bound :
+                         hpx::threads::thread_priority::default_);
+    }
+
+    // Execution policy for the parallel algorithms of a benchmark entry
+    inline auto benchmark_policy()
+    {
+        return hpx::execution::par.on(benchmark_executor());
+    }
+#endif
+
+    // Calls f(i) for every i in [0, n) as a task of its own. With HPX every
+    // call becomes an HPX thread on benchmark_executor(), otherwise
+    // benchmark_workers() threads take turns taking the next i.
+    template <typename F>
+    void run_tasks(std::uint64_t n, F&& f)
+    {
+#if LOCKS_WITH_HPX
+        std::vector<hpx::future<void>> futures;
+        futures.reserve(n);
+
+        auto exec = benchmark_executor();
+        for (std::uint64_t i = 0; i != n; ++i)
+            futures.emplace_back(hpx::async(exec, f, i));
+
+        hpx::wait_all(futures);
+#else
+        std::atomic<std::uint64_t> next{0};
+        auto worker = [&] {
+            for (std::uint64_t i = next.fetch_add(1, std::memory_order_relaxed);
+                 i < n; i = next.fetch_add(1, std::memory_order_relaxed))
+            {
+                f(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        std::size_t const workers = benchmark_workers();
+        for (std::size_t t = 1; t < workers; ++t)
+            threads.emplace_back(worker);
+        worker();
+
+        for (std::thread& t : threads)
+            t.join();
+#endif
+    }
+
+    // Calls f(i) for every i in [0, n) in parallel, the way a parallel
+    // algorithm would: with HPX through hpx::for_loop on benchmark_policy()
+    template <typename F>
+    void parallel_for(std::uint64_t n, F&& f)
+    {
+#if LOCKS_WITH_HPX
+        hpx::for_loop(benchmark_policy(), std::uint64_t(0), n, f);
+#else
+        run_tasks(n, f);
+#endif
+    }
+
+    // Combining and delegation locks take the critical section through
+    // execute(), possibly running it on a different thread.
+    template <typename LockType, typename F, typename Enable = void>
+    struct has_execute : std::false_type
+    {
+    };
+
+    template <typename LockType, typename F>
+    struct has_execute<LockType, F,
+        std::void_t<decltype(
+            std::declval<LockType&>().execute(std::declval<F&>()))>>
+      : std::true_type
+    {
+    };
+
+    // Runs f holding lock, neither traced nor recorded, see
+    // critical_section()
+    template <typename LockType, typename F>
+    void run_locked(LockType& lock, F&& f)
+    {
+        if constexpr (has_execute<LockType, F>::value)
+        {
+            lock.execute(f);
+        }
+        else
+        {
+            std::lock_guard<LockType> guard(lock);
+            f();
+        }
+    }
+
+    namespace detail {
+
+        // The critical section counts as acquired once f starts running,
+        // which works for execute() as well
+        template <typename LockType, typename F>
+        void run_critical_section(LockType& lock, F&& f)
+        {
+            if (!lock_tracer::enabled())
+            {
+                run_locked(lock, f);
+                return;
+            }
+
+            lock_tracer& tracer = lock_tracer::get();
+            std::uint64_t const id = tracer.requested(&lock);
+            run_locked(lock, [&] {
+                tracer.acquired(&lock, id);
+                f();
+                tracer.released(&lock, id);
+            });
+        }
+
+        template <typename LockType, typename F>
+        void run_recorded_critical_section(LockType& lock, F&& f)
+        {
+            acquire_recorder& recorder = acquire_recorder::get();
+
+            std::uint64_t const ticket = recorder.arrive();
+            std::uint64_t const start = platform::now();
+
+            std::uint64_t entry = 0;
+            std::uint64_t wait = 0;
+            run_critical_section(lock, [&] {
+                wait = platform::now() - start;
+                entry = recorder.enter();
+                f();
+            });
+
+            recorder.record(ticket, entry, wait);
+        }
+    }    // namespace detail
+
+    // Runs f in a critical section of lock. With --latency every call
+    // also records its wait time into acquire_recorder::get(), with
+    // --lock-trace it shows up in the trace of lock_tracer::get().
+    // The recorder counts entries under the lock, so with --latency all
+    // calls of a benchmark entry must go through the same lock.
+    template <typename LockType, typename F>
+    void critical_section(LockType& lock, F&& f)
+    {
+        if (benchmark_config().latency)
+            detail::run_recorded_critical_section(lock, f);
+        else
+            detail::run_critical_section(lock, f);
+    }
+
     template <typename Func>
     auto return_bounded_function(Func&& func, std::string const& name)
     {
         return std::make_pair(func, name);
     }
 
+    // Command line options tuning the locks, see util::backoff_config(),
+    // util::topology_config() and util::trace_config()
+    inline program_options::options_description lock_options()
+    {
+        backoff_parameters const defaults{};
+
+        program_options::options_description desc("Lock options");
+        desc.add_options()("backoff-min",
+            program_options::value<std::uint32_t>()->default_value(
+                defaults.min_delay),
+            "Minimum backoff delay (in pauses)");
+        desc.add_options()("backoff-max",
+            program_options::value<std::uint32_t>()->default_value(
+                defaults.max_delay),
+            "Maximum backoff delay (in pauses)");
+        desc.add_options()("backoff-growth",
+            program_options::value<double>()->default_value(
+                defaults.growth),
+            "Growth factor of the backoff delay");
+        desc.add_options()("backoff-adaptive",
+            "Adjust the backoff ceiling to the observed contention");
+        desc.add_options()("numa-nodes",
+            program_options::value<std::size_t>()->default_value(0),
+            "Simulate that many NUMA nodes (0: use the machine topology)");
+        desc.add_options()("lock-trace",
+            program_options::value<std::string>()->default_value(""),
+            "Write a Chrome trace of the lock acquisitions to this file");
+        desc.add_options()("lock-trace-events",
+            program_options::value<std::size_t>()->default_value(
+                trace_parameters{}.events_per_worker),
+            "Number of trace events kept per worker thread");
+
+        return desc;
+    }
+
+    // Returns false after printing the reason to std::cerr if the options
+    // are out of range
+    inline bool configure_locks(program_options::variables_map& vm)
+    {
+        backoff_parameters params;
+        params.min_delay = vm["backoff-min"].as<std::uint32_t>();
+        params.max_delay = vm["backoff-max"].as<std::uint32_t>();
+        params.growth = vm["backoff-growth"].as<double>();
+        params.adaptive = vm.count("backoff-adaptive") != 0;
+
+        if (params.min_delay == 0 || params.min_delay > params.max_delay)
+        {
+            std::cerr << "--backoff-min must be at least 1 and must not "
+                         "exceed --backoff-max\n";
+            return false;
+        }
+        if (!(params.growth > 1.0))
+        {
+            std::cerr << "--backoff-growth must be greater than 1\n";
+            return false;
+        }
+        backoff_config() = params;
+
+        topology_config().simulated_numa_nodes =
+            vm["numa-nodes"].as<std::size_t>();
+
+        trace_config().file = vm["lock-trace"].as<std::string>();
+        trace_config().events_per_worker =
+            vm["lock-trace-events"].as<std::size_t>();
+        return true;
+    }
+
+    // Command line options shaping the tasks of a util::workload, see
+    // util::workload_config()
+    inline program_options::options_description workload_options()
+    {
+        workload_parameters const defaults{};
+
+        program_options::options_description desc("Workload options");
+        desc.add_options()("grain-distribution",
+            program_options::value<std::string>()->default_value(
+                name_of(defaults.grain)),
+            "Distribution of the grain sizes around their mean: constant, "
+            "uniform, exponential, bimodal or pareto");
+        desc.add_options()("bimodal-fraction",
+            program_options::value<double>()->default_value(
+                defaults.bimodal_fraction),
+            "Fraction of long tasks of the bimodal distribution");
+        desc.add_options()("bimodal-ratio",
+            program_options::value<double>()->default_value(
+                defaults.bimodal_ratio),
+            "Grain size of the long tasks over that of the short ones");
+        desc.add_options()("pareto-shape",
+            program_options::value<double>()->default_value(
+                defaults.pareto_shape),
+            "Shape of the Pareto distribution (> 1, smaller is heavier)");
+        desc.add_options()("arrival",
+            program_options::value<std::string>()->default_value(
+                name_of(defaults.arrival)),
+            "Arrival of the tasks: all-at-once, poisson or bursts");
+        desc.add_options()("arrival-rate",
+            program_options::value<double>()->default_value(
+                defaults.arrival_rate),
+            "Tasks per second of the Poisson arrivals");
+        desc.add_options()("burst-size",
+            program_options::value<std::uint64_t>()->default_value(
+                defaults.burst_size),
+            "Number of tasks of every burst");
+        desc.add_options()("burst-period",
+            program_options::value<double>()->default_value(
+                defaults.burst_period),
+            "Time between two bursts (in us)");
+        desc.add_options()("seed",
+            program_options::value<std::uint64_t>()->default_value(
+                defaults.seed),
+            "Seed of the grain sizes and arrival times");
+
+        return desc;
+    }
+
+    // Returns false after printing the reason to std::cerr if the options
+    // describe no valid workload
+    inline bool configure_workload(program_options::variables_map& vm)
+    {
+        workload_parameters params;
+        if (!parse(vm["grain-distribution"].as<std::string>(), params.grain))
+        {
+            std::cerr << "unknown --grain-distribution\n";
+            return false;
+        }
+        if (!parse(vm["arrival"].as<std::string>(), params.arrival))
+        {
+            std::cerr << "unknown --arrival\n";
+            return false;
+        }
+
+        params.bimodal_fraction = vm["bimodal-fraction"].as<double>();
+        params.bimodal_ratio = vm["bimodal-ratio"].as<double>();
+        params.pareto_shape = vm["pareto-shape"].as<double>();
+        params.arrival_rate = vm["arrival-rate"].as<double>();
+        params.burst_size = vm["burst-size"].as<std::uint64_t>();
+        params.burst_period = vm["burst-period"].as<double>();
+        params.seed = vm["seed"].as<std::uint64_t>();
+
+        if (params.bimodal_fraction < 0.0 || params.bimodal_fraction > 1.0 ||
+            params.bimodal_ratio < 1.0)
+        {
+            std::cerr << "--bimodal-fraction must be in [0, 1] and "
+                         "--bimodal-ratio at least 1\n";
+            return false;
+        }
+        if (!(params.pareto_shape > 1.0))
+        {
+            std::cerr << "--pareto-shape must be greater than 1\n";
+            return false;
+        }
+        if (!(params.arrival_rate > 0.0) || params.burst_size == 0 ||
+            params.burst_period < 0.0)
+        {
+            std::cerr << "--arrival-rate and --burst-size must be positive "
+                         "and --burst-period must not be negative\n";
+            return false;
+        }
+
+        workload_config() = params;
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Summary of the timed runs of one benchmark entry, in seconds
+    struct benchmark_statistics
+    {
+        std::size_t samples{0};
+        double min{0.0};
+        double median{0.0};
+        double mean{0.0};
+        double stddev{0.0};
+
+        // Half width of the 95% confidence interval of the mean
+        double ci95{0.0};
+    };
+
+    namespace detail {
+
+        // 97.5% quantile of Student's t distribution with dof degrees of
+        // freedom, i.e. the factor of a two-sided 95% confidence interval
+        inline double student_t_975(std::size_t dof)
+        {
+            static double const table[] = {12.706, 4.303, 3.182, 2.776,
+                2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160,
+                2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074,
+                2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+            if (dof == 0)
+                return 0.0;
+            if (dof <= std::size(table))
+                return table[dof - 1];
+
+            // First order expansion around the normal quantile
+            return 1.960 + 2.37 / static_cast<double>(dof);
+        }
+
+        inline std::string csv_quoted(std::string const& str)
+        {
+            std::string result = "\"";
+            for (char c : str)
+            {
+                if (c == '"')
+                    result += '"';
+                result += c;
+            }
+            return result + '"';
+        }
+
+        inline std::string json_quoted(std::string const& str)
+        {
+            std::string result = "\"";
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    result += '\\';
+                result += c;
+            }
+            return result + '"';
+        }
+
+        template <typename T>
+        std::string json_value(T const& value)
+        {
+            std::ostringstream os;
+            os << std::setprecision(std::numeric_limits<double>::digits10)
+               << value;
+
+            if constexpr (std::is_arithmetic_v<T>)
+                return os.str();
+            else
+                return json_quoted(os.str());
+        }
+    }    // namespace detail
+
+    inline benchmark_statistics compute_statistics(std::vector<double> samples)
+    {
+        benchmark_statistics stats;
+        stats.samples = samples.size();
+        if (samples.empty())
+            return stats;
+
+        std::sort(samples.begin(), samples.end());
+
+        std::size_t const n = samples.size();
+        stats.min = samples.front();
+        stats.median = n % 2 != 0 ? samples[n / 2] :
+                                    (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+
+        if (n > 1)
+        {
+            double sum_sq = 0.0;
+            for (double sample : samples)
+                sum_sq += (sample - stats.mean) * (sample - stats.mean);
+
+            stats.stddev = std::sqrt(sum_sq / (n - 1));
+            stats.ci95 = detail::student_t_975(n - 1) * stats.stddev /
+                std::sqrt(static_cast<double>(n));
+        }
+
+        return stats;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Runs every entry warmup times untimed and repetitions times timed with
+    // the same arguments. Prints a table as it goes and writes the CSV and
+    // JSON reports after the last entry.
     template <typename... Tuple>
     class benchmark_invoker
     {
     public:
         benchmark_invoker(Tuple... args)
           : arg_list(args...)
+          , params(benchmark_config())
         {
-            std::cout << std::left << std::setw(50) << "Name: "
-                      << "Time (in s)" << '\n';
+            print_header();
         }
 
         void invoke()
         {
-            std::cout << std::left << std::setw(50) << "Name: "
-                      << "Time (in s)" << '\n';
+            print_header();
+
+            if (!params.csv_file.empty())
+                write_csv();
+            if (!params.json_file.empty())
+                write_json();
+        }
+
+        // Number of operations, e.g. tasks, one run of every entry performs.
+        // Throughput is reported in operations per second.
+        void set_operations(std::uint64_t ops)
+        {
+            operations = ops;
         }
 
         template <typename Func, typename... Args>
         void invoke(Func&& func, Args&&... args)
         {
-            hpx::chrono::high_resolution_timer t;
-            for (std::size_t i = 0u; i != 3; ++i)
+            if (params.sweep_threads.empty())
             {
-                hpx::util::invoke_fused(func.first, arg_list);
+                entry_result result = measure(func.first, func.second, 0);
+
+                benchmark_statistics const& stats = result.stats;
+                std::cout << std::left << std::setw(50) << func.second
+                          << std::setw(14) << stats.mean << std::setw(14)
+                          << stats.median << std::setw(14) << stats.min
+                          << std::setw(14) << stats.stddev << stats.ci95
+                          << '\n';
+                if (result.latency.acquisitions != 0)
+                    print_latency(result.latency);
+
+                results.push_back(std::move(result));
             }
-            double elapsed = t.elapsed() / 3;
+            else
+            {
+                // Speedup and efficiency are relative to the smallest
+                // thread count of the sweep
+                double baseline_time = 0.0;
+                std::size_t const baseline_threads =
+                    params.sweep_threads.front();
+
+                for (std::size_t threads : params.sweep_threads)
+                {
+                    entry_result result =
+                        measure(func.first, func.second, threads);
+
+                    if (threads == baseline_threads)
+                        baseline_time = result.stats.mean;
+
+                    result.speedup = result.stats.mean != 0.0 ?
+                        baseline_time / result.stats.mean :
+                        0.0;
+                    result.efficiency = result.speedup *
+                        static_cast<double>(baseline_threads) /
+                        static_cast<double>(threads);
 
-            std::cout << std::left << std::setw(50) << func.second << elapsed
-                      << '\n';
+                    std::cout << std::left << std::setw(50) << func.second
+                              << std::setw(9) << threads << std::setw(14)
+                              << result.stats.mean << std::setw(14)
+                              << result.stats.ci95 << std::setw(18)
+                              << result.throughput << std::setw(10)
+                              << result.speedup << result.efficiency
+                              << '\n';
+                    if (result.latency.acquisitions != 0)
+                        print_latency(result.latency);
+
+                    results.push_back(std::move(result));
+                }
+            }
 
             this->invoke(args...);
         }
 
     private:
+        struct entry_result
+        {
+            std::string name;
+            benchmark_statistics stats;
+
+            std::size_t threads{0};
+
+            // Operations per second of the mean run
+            double throughput{0.0};
+
+            // Zero unless the entry ran in a thread sweep
+            double speedup{0.0};
+            double efficiency{0.0};
+
+            // Empty unless the entry ran with --latency and went through
+            // critical_section()
+            acquire_summary latency;
+        };
+
+        // Runs func warmup times untimed and repetitions times timed on
+        // threads worker threads, all of them if threads is 0
+        template <typename F>
+        entry_result measure(F& func, std::string const& name,
+            std::size_t threads)
+        {
+            detail::active_workers() = threads;
+
+            for (std::size_t i = 0u; i != params.warmup; ++i)
+            {
+                std::apply(func, arg_list);
+            }
+
+            if (params.latency)
+                acquire_recorder::get().reset(benchmark_workers());
+
+            std::vector<double> samples;
+            samples.reserve(params.repetitions);
+            for (std::size_t i = 0u; i != params.repetitions; ++i)
+            {
+                platform::timer t;
+                std::apply(func, arg_list);
+                samples.push_back(t.elapsed());
+            }
+
+            entry_result result;
+            result.name = name;
+            result.stats = compute_statistics(std::move(samples));
+            result.threads = benchmark_workers();
+            if (result.stats.mean != 0.0)
+            {
+                result.throughput =
+                    static_cast<double>(operations) / result.stats.mean;
+            }
+            if (params.latency)
+                result.latency = acquire_recorder::get().summary();
+
+            detail::active_workers() = 0;
+            return result;
+        }
+
+        void print_header() const
+        {
+            if (params.sweep_threads.empty())
+            {
+                std::cout << std::left << std::setw(50) << "Name: "
+                          << std::setw(14) << "Time (in s)" << std::setw(14)
+                          << "Median" << std::setw(14) << "Min"
+                          << std::setw(14) << "Stddev"
+                          << "CI95 (+/-)" << '\n';
+            }
+            else
+            {
+                std::cout << std::left << std::setw(50) << "Name: "
+                          << std::setw(9) << "Threads" << std::setw(14)
+                          << "Time (in s)" << std::setw(14) << "CI95 (+/-)"
+                          << std::setw(18) << "Throughput (1/s)"
+                          << std::setw(10) << "Speedup"
+                          << "Efficiency" << '\n';
+            }
+        }
+
+        static void print_latency(acquire_summary const& latency)
+        {
+            auto const [fewest, most] = std::minmax_element(
+                latency.per_worker.begin(), latency.per_worker.end());
+
+            std::cout << "    wait (in ns): p50 " << latency.p50 << ", p99 "
+                      << latency.p99 << ", p99.9 " << latency.p999
+                      << ", max " << latency.max << "; fairness "
+                      << latency.fairness << ", max bypass "
+                      << latency.max_bypass << ", acquisitions per worker "
+                      << *fewest << " - " << *most << '\n';
+        }
+
+        std::string arguments_as_json() const
+        {
+            std::string result = "[";
+            std::apply(
+                [&result](auto const&... args) {
+                    std::size_t i = 0;
+                    ((result += (i++ != 0 ? ", " : "") +
+                          detail::json_value(args)),
+                        ...);
+                },
+                arg_list);
+            return result + "]";
+        }
+
+        // Appends one line per entry, the header only goes into new files.
+        // Runtime, HPX version and thread count are part of every line so
+        // that runs on different machines can be concatenated.
+        void write_csv() const
+        {
+            bool const exists = std::ifstream(params.csv_file).good();
+
+            std::ofstream out(params.csv_file, std::ios::app);
+            out << std::setprecision(std::numeric_limits<double>::digits10);
+
+            if (!exists)
+            {
+                out << "name,runtime,hpx_version,os_threads,threads,"
+                       "repetitions,min,median,mean,stddev,ci95_low,"
+                       "ci95_high,throughput,speedup,efficiency,p50_ns,"
+                       "p99_ns,p999_ns,max_ns,fairness,max_bypass\n";
+            }
+
+            for (entry_result const& result : results)
+            {
+                benchmark_statistics const& stats = result.stats;
+                out << detail::csv_quoted(result.name) << ','
+                    << platform::runtime_name << ','
+                    << detail::csv_quoted(platform::runtime_version())
+                    << ',' << platform::thread_count() << ','
+                    << result.threads << ',' << stats.samples << ','
+                    << stats.min << ',' << stats.median << ',' << stats.mean
+                    << ',' << stats.stddev << ',' << stats.mean - stats.ci95
+                    << ',' << stats.mean + stats.ci95 << ','
+                    << result.throughput;
+
+                if (result.speedup != 0.0)
+                    out << ',' << result.speedup << ',' << result.efficiency;
+                else
+                    out << ",,";
+
+                acquire_summary const& latency = result.latency;
+
+                if (latency.acquisitions != 0)
+                {
+                    out << ',' << latency.p50 << ',' << latency.p99 << ','
+                        << latency.p999 << ',' << latency.max << ','
+                        << latency.fairness << ',' << latency.max_bypass;
+                }
+                else
+                {
+                    out << ",,,,,,";
+                }
+                out << '\n';
+            }
+        }
+
+        static std::string latency_as_json(acquire_summary const& latency)
+        {
+            std::string per_worker = "[";
+            for (std::size_t i = 0; i != latency.per_worker.size(); ++i)
+            {
+                per_worker += (i != 0 ? ", " : "") +
+                    std::to_string(latency.per_worker[i]);
+            }
+            per_worker += "]";
+
+            return "{\"acquisitions\": " +
+                std::to_string(latency.acquisitions) +
+                ", \"p50_ns\": " + std::to_string(latency.p50) +
+                ", \"p99_ns\": " + std::to_string(latency.p99) +
+                ", \"p999_ns\": " + std::to_string(latency.p999) +
+                ", \"max_ns\": " + std::to_string(latency.max) +
+                ", \"fairness\": " + detail::json_value(latency.fairness) +
+                ", \"max_bypass\": " + std::to_string(latency.max_bypass) +
+                ", \"per_worker\": " + per_worker + "}";
+        }
+
+        void write_json() const
+        {
+            std::ofstream out(params.json_file);
+            out << std::setprecision(std::numeric_limits<double>::digits10);
+
+            out << "{\n"
+                << "  \"runtime\": "
+                << detail::json_quoted(platform::runtime_name) << ",\n"
+                << "  \"hpx_version\": "
+                << detail::json_quoted(platform::runtime_version()) << ",\n"
+                << "  \"os_threads\": " << platform::thread_count() << ",\n"
+                << "  \"warmup\": " << params.warmup << ",\n"
+                << "  \"repetitions\": " << params.repetitions << ",\n"
+                << "  \"arguments\": " << arguments_as_json() << ",\n"
+                << "  \"results\": [";
+
+            for (std::size_t i = 0; i != results.size(); ++i)
+            {
+                auto const& [name, stats, threads, throughput, speedup,
+                    efficiency, latency] = results[i];
+                out << (i != 0 ? "," : "") << "\n    {"
+                    << "\"name\": " << detail::json_quoted(name)
+                    << ", \"threads\": " << threads
+                    << ", \"min\": " << stats.min
+                    << ", \"median\": " << stats.median
+                    << ", \"mean\": " << stats.mean
+                    << ", \"stddev\": " << stats.stddev
+                    << ", \"ci95_low\": " << stats.mean - stats.ci95
+                    << ", \"ci95_high\": " << stats.mean + stats.ci95
+                    << ", \"throughput\": " << throughput;
+
+                if (speedup != 0.0)
+                {
+                    out << ", \"speedup\": " << speedup
+                        << ", \"efficiency\": " << efficiency;
+                }
+
+                if (latency.acquisitions != 0)
+                    out << ", \"latency\": " << latency_as_json(latency);
+                out << "}";
+            }
+
+            out << "\n  ]\n}\n";
+        }
+
         std::tuple<Tuple...> arg_list;
+        benchmark_parameters const params;
+        std::vector<entry_result> results;
+        std::uint64_t operations{1};
     };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Parses the command line described by desc, runs benchmark_main with
+    // the parsed options and shuts down, see platform::finalize(). With HPX
+    // the options also accept the --hpx: options and benchmark_main runs on
+    // an HPX thread, otherwise --threads sets the number of worker threads.
+    template <typename F>
+    int run_benchmark(int argc, char* argv[],
+        program_options::options_description const& desc, F&& benchmark_main)
+    {
+#if LOCKS_WITH_HPX
+        hpx::init_params init_args;
+        init_args.desc_cmdline = desc;
+
+        return hpx::init(
+            [&benchmark_main](program_options::variables_map& vm) {
+                int const result = benchmark_main(vm);
+                platform::finalize();    // Handles HPX shutdown
+                return result;
+            },
+            argc, argv, init_args);
+#else
+        program_options::options_description cmdline(desc);
+        cmdline.add_options()("threads,t",
+            program_options::value<std::size_t>()->default_value(
+                platform::thread_count()),
+            "Number of worker threads");
+        cmdline.add_options()("help,h", "Print the command line options");
+
+        program_options::variables_map vm;
+        try
+        {
+            program_options::store(
+                program_options::parse_command_line(argc, argv, cmdline), vm);
+            program_options::notify(vm);
+        }
+        catch (program_options::error const& e)
+        {
+            std::cerr << argv[0] << ": " << e.what() << '\n';
+            return 1;
+        }
+
+        if (vm.count("help") != 0)
+        {
+            std::cout << cmdline << '\n';
+            return 0;
+        }
+
+        platform::set_thread_count(vm["threads"].as<std::size_t>());
+
+        int const result = benchmark_main(vm);
+        platform::finalize();
+        return result;
+#endif
+    }
 }}    // namespace locks::util
 
 #define GET_FUNCTION_PAIR(f) locks::util::return_bounded_function(f, #f)
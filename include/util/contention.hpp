@@ -0,0 +1,237 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#if LOCKS_WITH_HPX
+#include <hpx/include/performance_counters.hpp>
+#include <hpx/modules/runtime_local.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace locks { namespace util {
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Totals over all worker threads, see contention_counters
+    struct contention_stats
+    {
+        std::uint64_t acquisitions{0};
+
+        // Acquisitions whose first try_lock() failed
+        std::uint64_t contended{0};
+
+        // Polls of the lock's wait policy while acquiring it
+        std::uint64_t polls{0};
+
+        // Time the lock was held, in nanoseconds
+        std::uint64_t hold_time{0};
+        std::uint64_t max_hold_time{0};
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Contention counters of one or more locks. Every worker thread counts
+    // into its own cache line. A worker runs a single thread at a time and
+    // counting never suspends, so each slot has a single writer and plain
+    // loads and stores suffice. Threads that are no workers share the last
+    // slot and may lose counts.
+    class contention_counters
+    {
+    public:
+        enum counter
+        {
+            acquisitions,
+            contended,
+            polls,
+            hold_time,
+            max_hold_time,
+            num_counters
+        };
+
+        // Locks may be created before the runtime, e.g. as globals
+        contention_counters()
+          : slots(std::max<std::size_t>(platform::thread_count(), 1) + 1)
+        {
+        }
+
+        void record_acquire(bool was_contended, std::uint64_t num_polls)
+        {
+            slot& s = current_slot();
+            add(s.values[acquisitions], 1);
+            if (was_contended)
+                add(s.values[contended], 1);
+            if (num_polls != 0)
+                add(s.values[polls], num_polls);
+        }
+
+        void record_release(std::uint64_t held_ns)
+        {
+            slot& s = current_slot();
+            add(s.values[hold_time], held_ns);
+
+            std::atomic<std::uint64_t>& max = s.values[max_hold_time];
+            if (held_ns > max.load(std::memory_order_relaxed))
+                max.store(held_ns, std::memory_order_relaxed);
+        }
+
+        // Sum (maximum for max_hold_time) over all worker threads. Resetting
+        // while the lock is in use may miss concurrent updates.
+        std::uint64_t value(counter c, bool reset = false)
+        {
+            std::uint64_t result = 0;
+            for (slot& s : slots)
+            {
+                std::uint64_t const v =
+                    reset ? s.values[c].exchange(0, std::memory_order_relaxed) :
+                            s.values[c].load(std::memory_order_relaxed);
+                result = c == max_hold_time ? std::max(result, v) : result + v;
+            }
+            return result;
+        }
+
+        contention_stats stats()
+        {
+            contention_stats result;
+            result.acquisitions = value(acquisitions);
+            result.contended = value(contended);
+            result.polls = value(polls);
+            result.hold_time = value(hold_time);
+            result.max_hold_time = value(max_hold_time);
+            return result;
+        }
+
+        void reset()
+        {
+            for (std::size_t c = 0; c != num_counters; ++c)
+                value(static_cast<counter>(c), true);
+        }
+
+    private:
+        struct alignas(policy::cache_line_size) slot
+        {
+            std::atomic<std::uint64_t> values[num_counters]{};
+        };
+
+        static void add(std::atomic<std::uint64_t>& value, std::uint64_t n)
+        {
+            value.store(value.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+        }
+
+        slot& current_slot()
+        {
+            std::size_t const worker = platform::thread_index();
+            return slots[std::min(worker, slots.size() - 1)];
+        }
+
+        std::vector<slot> slots;
+    };
+
+#if LOCKS_WITH_HPX
+    namespace detail {
+
+        inline void install_contention_counters(std::string const& name,
+            std::shared_ptr<contention_counters> const& counters)
+        {
+            struct counter_info
+            {
+                char const* name;
+                contention_counters::counter counter;
+                char const* help;
+                char const* unit;
+            };
+
+            static counter_info const infos[] = {
+                {"acquisitions", contention_counters::acquisitions,
+                    "number of acquisitions", ""},
+                {"contended", contention_counters::contended,
+                    "number of acquisitions that had to wait", ""},
+                {"polls", contention_counters::polls,
+                    "number of polls while waiting for the lock", ""},
+                {"hold-time/total", contention_counters::hold_time,
+                    "total time the lock was held", "ns"},
+                {"hold-time/max", contention_counters::max_hold_time,
+                    "longest time the lock was held", "ns"},
+            };
+
+            for (counter_info const& info : infos)
+            {
+                contention_counters::counter const c = info.counter;
+                hpx::performance_counters::install_counter_type(
+                    "/locks/" + name + "/" + info.name,
+                    [counters, c](bool reset) -> std::int64_t {
+                        return static_cast<std::int64_t>(
+                            counters->value(c, reset));
+                    },
+                    std::string("returns the ") + info.help + " of the '" +
+                        name + "' locks",
+                    info.unit);
+            }
+        }
+    }    // namespace detail
+#endif
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Contention counters by name. All locks registered under one name share
+    // their counters, which with HPX are exposed as the performance counters
+    //
+    //     /locks{locality#0/total}/<name>/acquisitions
+    //     /locks{locality#0/total}/<name>/contended
+    //     /locks{locality#0/total}/<name>/polls
+    //     /locks{locality#0/total}/<name>/hold-time/total
+    //     /locks{locality#0/total}/<name>/hold-time/max
+    //
+    // e.g. for --hpx:print-counter. Counters outlive their locks.
+    class contention_registry
+    {
+    public:
+        static contention_registry& get()
+        {
+            static contention_registry registry;
+            return registry;
+        }
+
+        std::shared_ptr<contention_counters> counters(std::string const& name)
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+
+            std::shared_ptr<contention_counters>& entry = by_name[name];
+            if (entry == nullptr)
+            {
+                entry = std::make_shared<contention_counters>();
+
+#if LOCKS_WITH_HPX
+                // Counter types can only be installed by a running runtime
+                if (hpx::is_running())
+                {
+                    detail::install_contention_counters(name, entry);
+                }
+                else
+                {
+                    hpx::register_startup_function([name, entry = entry] {
+                        detail::install_contention_counters(name, entry);
+                    });
+                }
+#endif
+            }
+            return entry;
+        }
+
+    private:
+        contention_registry() = default;
+
+        std::mutex mtx;
+        std::map<std::string, std::shared_ptr<contention_counters>> by_name;
+    };
+
+}}    // namespace locks::util
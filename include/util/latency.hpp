@@ -0,0 +1,246 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace locks { namespace util {
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Histogram with logarithmic buckets in the spirit of HdrHistogram. Every
+    // power of two is split into 2^sub_bucket_bits linear buckets, so any
+    // recorded value is reported within 1/2^sub_bucket_bits of its true
+    // value while the whole uint64 range fits into a few KB.
+    class log_histogram
+    {
+    public:
+        static constexpr std::size_t sub_bucket_bits = 4;
+        static constexpr std::size_t sub_buckets = std::size_t(1)
+            << sub_bucket_bits;
+        static constexpr std::size_t num_buckets =
+            sub_buckets + (64 - sub_bucket_bits) * sub_buckets;
+
+        void record(std::uint64_t value)
+        {
+            ++buckets[bucket_of(value)];
+            ++count_;
+            max_ = std::max(max_, value);
+        }
+
+        void merge(log_histogram const& other)
+        {
+            for (std::size_t i = 0; i != num_buckets; ++i)
+                buckets[i] += other.buckets[i];
+            count_ += other.count_;
+            max_ = std::max(max_, other.max_);
+        }
+
+        std::uint64_t count() const
+        {
+            return count_;
+        }
+
+        std::uint64_t max() const
+        {
+            return max_;
+        }
+
+        // Smallest recorded value v such that at least the given fraction of
+        // all values is <= v, rounded up to the end of its bucket
+        std::uint64_t percentile(double fraction) const
+        {
+            if (count_ == 0)
+                return 0;
+
+            std::uint64_t const rank = std::max<std::uint64_t>(1,
+                static_cast<std::uint64_t>(fraction * count_ + 0.5));
+
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i != num_buckets; ++i)
+            {
+                seen += buckets[i];
+                if (seen >= rank)
+                    return std::min(highest_in_bucket(i), max_);
+            }
+            return max_;
+        }
+
+    private:
+        static std::size_t log2_floor(std::uint64_t value)
+        {
+            std::size_t result = 0;
+            for (std::size_t shift = 32; shift != 0; shift /= 2)
+            {
+                if (value >= (std::uint64_t(1) << shift))
+                {
+                    value >>= shift;
+                    result += shift;
+                }
+            }
+            return result;
+        }
+
+        static std::size_t bucket_of(std::uint64_t value)
+        {
+            if (value < sub_buckets)
+                return static_cast<std::size_t>(value);
+
+            std::size_t const exponent = log2_floor(value);
+            std::size_t const shift = exponent - sub_bucket_bits;
+            std::size_t const sub =
+                static_cast<std::size_t>(value >> shift) - sub_buckets;
+
+            return sub_buckets + shift * sub_buckets + sub;
+        }
+
+        static std::uint64_t highest_in_bucket(std::size_t bucket)
+        {
+            if (bucket < sub_buckets)
+                return bucket;
+
+            std::size_t const shift = (bucket - sub_buckets) / sub_buckets;
+            std::uint64_t const sub = (bucket - sub_buckets) % sub_buckets;
+
+            return ((sub_buckets + sub + 1) << shift) - 1;
+        }
+
+        std::array<std::uint64_t, num_buckets> buckets{};
+        std::uint64_t count_{0};
+        std::uint64_t max_{0};
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // What acquire_recorder observed during one benchmark entry
+    struct acquire_summary
+    {
+        std::uint64_t acquisitions{0};
+
+        // Wait time from calling lock() until entering the critical section,
+        // in nanoseconds
+        std::uint64_t p50{0};
+        std::uint64_t p99{0};
+        std::uint64_t p999{0};
+        std::uint64_t max{0};
+
+        std::vector<std::uint64_t> per_worker{};
+
+        // Jain's fairness index of the acquisitions per worker thread: 1 if
+        // every worker got the lock equally often, 1/n if a single one of n
+        // workers got it
+        double fairness{0.0};
+
+        std::uint64_t max_bypass{0};
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Records the wait time and the bypass count of every acquisition. Each
+    // worker thread records into its own histogram, the histograms are
+    // merged by summary().
+    //
+    // The bypass count of an acquisition is the number of threads that
+    // entered the critical section before it even though they arrived after
+    // it, net of the threads it overtook itself. Arrivals draw a ticket, the
+    // critical section counts entries under the lock; an entry with ticket t
+    // that is the e-th one to enter has been bypassed e - t times.
+    class acquire_recorder
+    {
+    public:
+        static acquire_recorder& get()
+        {
+            static acquire_recorder recorder;
+            return recorder;
+        }
+
+        // Drops everything recorded so far and prepares for num_workers
+        // worker threads, must not be called while the benchmark is running
+        void reset(std::size_t num_workers)
+        {
+            workers.assign(std::max<std::size_t>(num_workers, 1), {});
+            arrivals.store(0, std::memory_order_relaxed);
+            entries = 0;
+        }
+
+        // Called before acquiring the lock
+        std::uint64_t arrive()
+        {
+            return arrivals.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Called inside the critical section, the lock protects entries
+        std::uint64_t enter()
+        {
+            return entries++;
+        }
+
+        // Called after leaving the critical section
+        void record(
+            std::uint64_t ticket, std::uint64_t entry, std::uint64_t wait_ns)
+        {
+            worker_record& w =
+                workers[platform::thread_index() % workers.size()];
+
+            w.waits.record(wait_ns);
+            ++w.acquisitions;
+            w.max_bypass =
+                std::max(w.max_bypass, entry > ticket ? entry - ticket : 0);
+        }
+
+        acquire_summary summary() const
+        {
+            acquire_summary result;
+
+            log_histogram merged;
+            double sum = 0.0;
+            double sum_sq = 0.0;
+            for (worker_record const& w : workers)
+            {
+                merged.merge(w.waits);
+                result.per_worker.push_back(w.acquisitions);
+                result.max_bypass = std::max(result.max_bypass, w.max_bypass);
+
+                sum += static_cast<double>(w.acquisitions);
+                sum_sq += static_cast<double>(w.acquisitions) *
+                    static_cast<double>(w.acquisitions);
+            }
+
+            result.acquisitions = merged.count();
+            result.p50 = merged.percentile(0.5);
+            result.p99 = merged.percentile(0.99);
+            result.p999 = merged.percentile(0.999);
+            result.max = merged.max();
+
+            if (sum_sq != 0.0)
+                result.fairness = sum * sum / (workers.size() * sum_sq);
+
+            return result;
+        }
+
+    private:
+        acquire_recorder()
+        {
+            reset(platform::thread_count());
+        }
+
+        struct alignas(policy::cache_line_size) worker_record
+        {
+            log_histogram waits;
+            std::uint64_t acquisitions{0};
+            std::uint64_t max_bypass{0};
+        };
+
+        std::vector<worker_record> workers;
+
+        alignas(policy::cache_line_size)
+            std::atomic<std::uint64_t> arrivals{0};
+        alignas(policy::cache_line_size) std::uint64_t entries{0};
+    };
+
+}}    // namespace locks::util
@@ -0,0 +1,52 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+
+namespace locks { namespace util {
+
+    // Keeps one spare queue node per worker thread so that queue locks can
+    // hand a released node over to the next acquire instead of going through
+    // the allocator.
+    template <typename Node>
+    class node_cache
+    {
+    private:
+        struct holder
+        {
+            ~holder()
+            {
+                delete node;
+            }
+
+            Node* node{nullptr};
+        };
+
+        // HPX threads may be resumed on a different worker, never let the
+        // compiler reuse a thread-local address across a suspension point
+        LOCKS_NOINLINE static Node*& slot()
+        {
+            static thread_local holder h;
+            return h.node;
+        }
+
+    public:
+        static Node* acquire()
+        {
+            Node*& spare = slot();
+            Node* node = spare;
+            spare = nullptr;
+
+            return node != nullptr ? node : new Node{};
+        }
+
+        static void release(Node* node)
+        {
+            Node*& spare = slot();
+            delete spare;
+            spare = node;
+        }
+    };
+
+}}    // namespace locks::util
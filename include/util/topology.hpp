@@ -0,0 +1,219 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace locks { namespace util {
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Setting simulated_numa_nodes to a non-zero value makes numa_topology
+    // pretend the machine has that many NUMA nodes, worker thread i being
+    // placed on node i % simulated_numa_nodes. Change it before the first
+    // call to numa_topology::get().
+    struct topology_parameters
+    {
+        std::size_t simulated_numa_nodes{0};
+    };
+
+    inline topology_parameters& topology_config()
+    {
+        static topology_parameters params;
+        return params;
+    }
+
+    namespace detail {
+
+        // Parses a sysfs cpu/node list such as "0-3,8-11"
+        inline std::vector<std::size_t> parse_sysfs_list(
+            std::string const& list)
+        {
+            std::vector<std::size_t> result;
+
+            std::stringstream ss(list);
+            std::string range;
+            while (std::getline(ss, range, ','))
+            {
+                if (range.empty() || range == "\n")
+                    continue;
+
+                std::size_t const dash = range.find('-');
+                std::size_t const first = std::stoul(range.substr(0, dash));
+                std::size_t const last = dash == std::string::npos ?
+                    first :
+                    std::stoul(range.substr(dash + 1));
+
+                for (std::size_t i = first; i <= last; ++i)
+                    result.push_back(i);
+            }
+
+            return result;
+        }
+
+        inline std::string read_sysfs_file(std::string const& path)
+        {
+            std::ifstream file(path);
+            std::string content;
+            std::getline(file, content);
+            return content;
+        }
+    }    // namespace detail
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Mapping from CPUs to NUMA nodes as reported by Linux sysfs. Nodes are
+    // renumbered densely from 0, machines without NUMA information are
+    // treated as a single node.
+    class numa_topology
+    {
+    public:
+        static numa_topology const& get()
+        {
+            static numa_topology const topology;
+            return topology;
+        }
+
+        std::size_t num_nodes() const
+        {
+            return num_nodes_;
+        }
+
+        std::size_t node_of_cpu(std::size_t cpu) const
+        {
+            return cpu < cpu_to_node.size() ? cpu_to_node[cpu] : 0;
+        }
+
+        // NUMA node the calling thread currently runs on
+        std::size_t current_node() const
+        {
+            if (simulated)
+                return platform::thread_index() % num_nodes_;
+
+#if defined(__linux__)
+            int const cpu = sched_getcpu();
+            return cpu < 0 ? 0 : node_of_cpu(static_cast<std::size_t>(cpu));
+#else
+            return 0;
+#endif
+        }
+
+    private:
+        numa_topology()
+        {
+            std::size_t const simulated_nodes =
+                topology_config().simulated_numa_nodes;
+            if (simulated_nodes != 0)
+            {
+                simulated = true;
+                num_nodes_ = simulated_nodes;
+                return;
+            }
+
+            std::string const base = "/sys/devices/system/node/";
+            std::vector<std::size_t> const nodes = detail::parse_sysfs_list(
+                detail::read_sysfs_file(base + "online"));
+
+            std::size_t dense_id = 0;
+            for (std::size_t node : nodes)
+            {
+                std::vector<std::size_t> const cpus =
+                    detail::parse_sysfs_list(detail::read_sysfs_file(
+                        base + "node" + std::to_string(node) + "/cpulist"));
+                if (cpus.empty())
+                    continue;    // memory-only node
+
+                for (std::size_t cpu : cpus)
+                {
+                    if (cpu >= cpu_to_node.size())
+                        cpu_to_node.resize(cpu + 1, 0);
+                    cpu_to_node[cpu] = dense_id;
+                }
+                ++dense_id;
+            }
+
+            num_nodes_ = dense_id != 0 ? dense_id : 1;
+        }
+
+        std::vector<std::size_t> cpu_to_node;
+        std::size_t num_nodes_{1};
+        bool simulated{false};
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Package (socket) and core of every online CPU as reported by Linux
+    // sysfs, CPUs of the same core are SMT siblings. Without sysfs every CPU
+    // is a core of its own on a single package.
+    class cpu_topology
+    {
+    public:
+        static cpu_topology const& get()
+        {
+            static cpu_topology const topology;
+            return topology;
+        }
+
+        // Online CPUs in increasing order
+        std::vector<std::size_t> const& cpus() const
+        {
+            return cpus_;
+        }
+
+        std::size_t package_of(std::size_t cpu) const
+        {
+            return cpu < packages.size() ? packages[cpu] : 0;
+        }
+
+        // Unique within the package of the CPU only
+        std::size_t core_of(std::size_t cpu) const
+        {
+            return cpu < cores.size() ? cores[cpu] : cpu;
+        }
+
+    private:
+        cpu_topology()
+        {
+            std::string const base = "/sys/devices/system/cpu/";
+            cpus_ = detail::parse_sysfs_list(
+                detail::read_sysfs_file(base + "online"));
+
+            if (cpus_.empty())
+            {
+                std::size_t const count = std::max<std::size_t>(
+                    std::thread::hardware_concurrency(), 1);
+                for (std::size_t cpu = 0; cpu != count; ++cpu)
+                    cpus_.push_back(cpu);
+            }
+
+            packages.resize(cpus_.back() + 1, 0);
+            cores.resize(cpus_.back() + 1, 0);
+            for (std::size_t cpu : cpus_)
+            {
+                std::string const dir =
+                    base + "cpu" + std::to_string(cpu) + "/topology/";
+                std::string const package =
+                    detail::read_sysfs_file(dir + "physical_package_id");
+                std::string const core =
+                    detail::read_sysfs_file(dir + "core_id");
+
+                packages[cpu] = package.empty() ? 0 : std::stoul(package);
+                cores[cpu] = core.empty() ? cpu : std::stoul(core);
+            }
+        }
+
+        std::vector<std::size_t> cpus_;
+        std::vector<std::size_t> packages;
+        std::vector<std::size_t> cores;
+    };
+
+}}    // namespace locks::util
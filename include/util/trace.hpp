@@ -0,0 +1,274 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace locks { namespace util {
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Lock tracing is off unless file names the Chrome trace to write at
+    // shutdown. Change it before the first call to lock_tracer::get().
+    struct trace_parameters
+    {
+        std::string file{};
+
+        // Capacity of the ring buffer of every worker thread, older events
+        // are overwritten
+        std::size_t events_per_worker{std::size_t(1) << 16};
+    };
+
+    inline trace_parameters& trace_config()
+    {
+        static trace_parameters params;
+        return params;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Records when a lock is requested, acquired and released. Every worker
+    // thread appends to its own ring buffer. At shutdown the events are
+    // paired up by acquisition and written as Chrome trace events: one
+    // "wait" interval from request to acquire on the requesting worker, one
+    // "hold" interval from acquire to release on the acquiring worker. The
+    // file can be opened in chrome://tracing or ui.perfetto.dev.
+    class lock_tracer
+    {
+    public:
+        enum event_type : std::uint32_t
+        {
+            request,
+            acquire,
+            release
+        };
+
+        static bool enabled()
+        {
+            return !trace_config().file.empty();
+        }
+
+        static lock_tracer& get()
+        {
+            static lock_tracer tracer;
+            return tracer;
+        }
+
+        // Returns the id of the acquisition to pass to acquired() and
+        // released()
+        std::uint64_t requested(void const* lock)
+        {
+            std::size_t const index = current_index();
+            buffer& b = *buffers[index];
+
+            // Unique without a shared counter
+            std::uint64_t const id = (std::uint64_t(index) << 48) |
+                b.acquisitions.fetch_add(1, std::memory_order_relaxed);
+
+            b.push(event{now(), lock, id, request});
+            return id;
+        }
+
+        void acquired(void const* lock, std::uint64_t id)
+        {
+            current_buffer().push(event{now(), lock, id, acquire});
+        }
+
+        void released(void const* lock, std::uint64_t id)
+        {
+            current_buffer().push(event{now(), lock, id, release});
+        }
+
+        // Shows the lock under name instead of its address
+        void name_lock(void const* lock, std::string const& name)
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            names[lock] = name;
+        }
+
+        // Must not be called while locks are being traced
+        void write(std::string const& file) const;
+
+    private:
+        struct event
+        {
+            std::uint64_t time;
+            void const* lock;
+            std::uint64_t id;
+            event_type type;
+        };
+
+        // Written by its worker thread only, except for threads that are no
+        // workers which share the last buffer
+        struct buffer
+        {
+            explicit buffer(std::size_t capacity)
+              : events(capacity)
+            {
+            }
+
+            void push(event const& e)
+            {
+                std::uint64_t const i =
+                    head.fetch_add(1, std::memory_order_relaxed);
+                events[i % events.size()] = e;
+            }
+
+            std::vector<event> events;
+            std::atomic<std::uint64_t> head{0};
+            std::atomic<std::uint64_t> acquisitions{0};
+        };
+
+        lock_tracer()
+        {
+            std::size_t const workers = platform::thread_count();
+            std::size_t const capacity =
+                std::max<std::size_t>(trace_config().events_per_worker, 1);
+
+            // One more for the threads that are no workers
+            std::size_t const num_buffers =
+                std::max<std::size_t>(workers, 1) + 1;
+            for (std::size_t i = 0; i != num_buffers; ++i)
+                buffers.push_back(std::make_unique<buffer>(capacity));
+
+            std::string const file = trace_config().file;
+            platform::at_shutdown([this, file] { write(file); });
+        }
+
+        static std::uint64_t now()
+        {
+            return platform::now();
+        }
+
+        std::size_t current_index() const
+        {
+            std::size_t const worker = platform::thread_index();
+            return std::min(worker, buffers.size() - 1);
+        }
+
+        buffer& current_buffer()
+        {
+            return *buffers[current_index()];
+        }
+
+        std::vector<std::unique_ptr<buffer>> buffers;
+
+        mutable std::mutex mtx;
+        std::map<void const*, std::string> names;
+    };
+
+    inline void lock_tracer::write(std::string const& file) const
+    {
+        struct acquisition
+        {
+            std::uint64_t time[3]{};
+            std::size_t worker[3]{};
+            void const* lock{nullptr};
+            bool seen[3]{};
+        };
+
+        std::unordered_map<std::uint64_t, acquisition> acquisitions;
+        std::uint64_t start = ~std::uint64_t(0);
+
+        for (std::size_t w = 0; w != buffers.size(); ++w)
+        {
+            buffer const& b = *buffers[w];
+            std::uint64_t const head = b.head.load(std::memory_order_acquire);
+            std::uint64_t const first =
+                head > b.events.size() ? head - b.events.size() : 0;
+
+            for (std::uint64_t i = first; i != head; ++i)
+            {
+                event const& e = b.events[i % b.events.size()];
+
+                acquisition& a = acquisitions[e.id];
+                a.time[e.type] = e.time;
+                a.worker[e.type] = w;
+                a.lock = e.lock;
+                a.seen[e.type] = true;
+
+                start = std::min(start, e.time);
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(mtx);
+
+        auto lock_name = [this](void const* lock) {
+            std::ostringstream os;
+            auto const it = names.find(lock);
+            if (it == names.end())
+            {
+                os << lock;
+                return os.str();
+            }
+
+            for (char c : it->second)
+            {
+                if (c == '"' || c == '\\')
+                    os << '\\';
+                os << c;
+            }
+            return os.str();
+        };
+
+        auto const us = [start](std::uint64_t time) {
+            return static_cast<double>(time - start) / 1000.0;
+        };
+
+        std::ofstream out(file);
+        out << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+
+        bool first = true;
+        auto interval = [&](char const* name, std::size_t worker,
+                            std::uint64_t begin, std::uint64_t end,
+                            void const* lock) {
+            out << (first ? "" : ",") << "\n  {\"name\": \"" << name
+                << "\", \"cat\": \"lock\", \"ph\": \"X\", \"pid\": 0, "
+                << "\"tid\": " << worker << ", \"ts\": " << us(begin)
+                << ", \"dur\": " << us(end) - us(begin)
+                << ", \"args\": {\"lock\": \"" << lock_name(lock) << "\"}}";
+            first = false;
+        };
+
+        // Acquisitions whose events got overwritten are left out
+        for (auto const& [id, a] : acquisitions)
+        {
+            if (a.seen[request] && a.seen[acquire])
+            {
+                interval("wait", a.worker[request], a.time[request],
+                    a.time[acquire], a.lock);
+            }
+            if (a.seen[acquire] && a.seen[release])
+            {
+                interval("hold", a.worker[acquire], a.time[acquire],
+                    a.time[release], a.lock);
+            }
+        }
+
+        for (std::size_t w = 0; w != buffers.size(); ++w)
+        {
+            out << (first ? "" : ",")
+                << "\n  {\"name\": \"thread_name\", \"ph\": \"M\", "
+                << "\"pid\": 0, \"tid\": " << w << ", \"args\": {\"name\": \""
+                << (w + 1 != buffers.size() ? "worker " + std::to_string(w) :
+                                              std::string("other threads"))
+                << "\"}}";
+            first = false;
+        }
+
+        out << "\n], \"displayTimeUnit\": \"ns\"}\n";
+    }
+
+}}    // namespace locks::util
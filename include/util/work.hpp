@@ -0,0 +1,126 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <locks/policies.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace locks { namespace util {
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Artificial work of the benchmarks. Reading a clock in a loop puts the
+    // clock into the measurement, so the work is a fixed number of
+    // iterations of an arithmetic kernel instead, sized once at startup by
+    // calibrate_work().
+    struct work_parameters
+    {
+        // Kernel iterations per microsecond, 0 until calibrated
+        double iterations_per_us{0.0};
+    };
+
+    inline work_parameters& work_config()
+    {
+        static work_parameters params;
+        return params;
+    }
+
+    namespace detail {
+
+        // A chain of dependent multiply-adds, the barrier keeps the compiler
+        // from computing the result in closed form or vectorizing the loop
+        inline std::uint64_t work_kernel(std::uint64_t iterations)
+        {
+            std::uint64_t x = iterations;
+            for (std::uint64_t i = 0; i != iterations; ++i)
+            {
+                x = x * 6364136223846793005ull + 1442695040888963407ull;
+#if defined(__GNUC__)
+                asm volatile("" : "+r"(x));
+#endif
+            }
+            return x;
+        }
+    }    // namespace detail
+
+    // Runs the kernel for the given number of iterations, see work_for()
+    inline void spin_work(std::uint64_t iterations)
+    {
+        std::uint64_t volatile sink = detail::work_kernel(iterations);
+        static_cast<void>(sink);
+    }
+
+    // Number of kernel iterations taking us microseconds
+    inline std::uint64_t work_for(double us)
+    {
+        return static_cast<std::uint64_t>(
+            std::llround(us * work_config().iterations_per_us));
+    }
+
+    // Measures the speed of the kernel on the calling thread. Every round
+    // doubles its iterations until it runs for at least a millisecond, the
+    // fastest round counts since it saw the fewest interruptions.
+    inline void calibrate_work()
+    {
+        std::uint64_t iterations = 1024;
+        double best = 0.0;
+        for (int round = 0; round != 5; ++round)
+        {
+            double elapsed = 0.0;
+            while (true)
+            {
+                platform::timer t;
+                spin_work(iterations);
+                elapsed = t.elapsed();
+                if (elapsed >= 1e-3)
+                    break;
+                iterations *= 2;
+            }
+            best = std::max(
+                best, static_cast<double>(iterations) / (elapsed * 1e6));
+        }
+        work_config().iterations_per_us = best;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Cache lines shared by the critical sections of a benchmark. Every
+    // update() reads and writes all of them, so every lock handoff also
+    // moves that many lines to the next holder. Not thread-safe, call it
+    // under a lock.
+    class shared_data
+    {
+    public:
+        explicit shared_data(std::size_t lines)
+          : lines_(lines)
+        {
+        }
+
+        void update()
+        {
+            for (cache_line& line : lines_)
+            {
+                for (std::uint64_t& word : line.words)
+                    ++word;
+            }
+        }
+
+        std::size_t size() const
+        {
+            return lines_.size();
+        }
+
+    private:
+        struct alignas(policy::cache_line_size) cache_line
+        {
+            std::uint64_t words[policy::cache_line_size /
+                sizeof(std::uint64_t)]{};
+        };
+
+        std::vector<cache_line> lines_;
+    };
+}}    // namespace locks::util
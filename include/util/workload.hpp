@@ -0,0 +1,296 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#pragma once
+
+#include <locks/platform.hpp>
+#include <util/work.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace locks { namespace util {
+
+    enum class grain_distribution
+    {
+        constant,
+        uniform,
+        exponential,
+        // Short tasks with a fraction of long ones
+        bimodal,
+        // Heavy-tailed
+        pareto
+    };
+
+    enum class arrival_process
+    {
+        all_at_once,
+        poisson,
+        // Tasks arrive in groups of burst_size every burst_period
+        bursts
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Shape of the tasks of a workload. The mean grain size is an argument
+    // of the workload, the distribution keeps it.
+    struct workload_parameters
+    {
+        grain_distribution grain{grain_distribution::constant};
+
+        // Fraction of long tasks and how much longer they are than the
+        // short ones
+        double bimodal_fraction{0.1};
+        double bimodal_ratio{10.0};
+
+        // Tail index, must exceed 1 for the mean to exist. The smaller, the
+        // heavier the tail.
+        double pareto_shape{1.5};
+
+        arrival_process arrival{arrival_process::all_at_once};
+
+        // Tasks per second of the Poisson process
+        double arrival_rate{100000.0};
+
+        std::uint64_t burst_size{100};
+        // In microseconds
+        double burst_period{1000.0};
+
+        std::uint64_t seed{0};
+    };
+
+    inline workload_parameters& workload_config()
+    {
+        static workload_parameters params;
+        return params;
+    }
+
+    inline char const* name_of(grain_distribution grain)
+    {
+        switch (grain)
+        {
+        case grain_distribution::constant:
+            return "constant";
+        case grain_distribution::uniform:
+            return "uniform";
+        case grain_distribution::exponential:
+            return "exponential";
+        case grain_distribution::bimodal:
+            return "bimodal";
+        case grain_distribution::pareto:
+            return "pareto";
+        }
+        return "unknown";
+    }
+
+    inline char const* name_of(arrival_process arrival)
+    {
+        switch (arrival)
+        {
+        case arrival_process::all_at_once:
+            return "all-at-once";
+        case arrival_process::poisson:
+            return "poisson";
+        case arrival_process::bursts:
+            return "bursts";
+        }
+        return "unknown";
+    }
+
+    // False if name is none of the names of name_of()
+    inline bool parse(std::string const& name, grain_distribution& grain)
+    {
+        for (grain_distribution g :
+            {grain_distribution::constant, grain_distribution::uniform,
+                grain_distribution::exponential, grain_distribution::bimodal,
+                grain_distribution::pareto})
+        {
+            if (name == name_of(g))
+            {
+                grain = g;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool parse(std::string const& name, arrival_process& arrival)
+    {
+        for (arrival_process a : {arrival_process::all_at_once,
+                 arrival_process::poisson, arrival_process::bursts})
+        {
+            if (name == name_of(a))
+            {
+                arrival = a;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // The grain size and arrival time of every task of a benchmark run,
+    // drawn up front so that drawing them is not measured. The same
+    // parameters and seed give the same tasks on every machine: the draws
+    // use std::mt19937_64, whose output the standard fixes, and their own
+    // inverse transforms instead of the implementation-defined
+    // std::*_distribution.
+    class workload
+    {
+    public:
+        // grain_size is the mean grain size in microseconds, converted to
+        // kernel iterations, see calibrate_work()
+        workload(std::uint64_t num_tasks, double grain_size,
+            workload_parameters const& params = workload_config());
+
+        std::uint64_t size() const
+        {
+            return work_.size();
+        }
+
+        // Kernel iterations of task i
+        std::uint64_t work(std::uint64_t i) const
+        {
+            return work_[i];
+        }
+
+        // Arrival time of task i in nanoseconds after the start of the run
+        std::uint64_t arrival(std::uint64_t i) const
+        {
+            return arrivals_.empty() ? 0 : arrivals_[i];
+        }
+
+        // Yields until task i has arrived, start is platform::now() at the
+        // start of the run
+        void wait_for_arrival(std::uint64_t i, std::uint64_t start) const
+        {
+            if (arrivals_.empty())
+                return;
+
+            std::uint64_t const due = start + arrivals_[i];
+            while (platform::now() < due)
+                platform::yield();
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, workload const& w);
+
+    private:
+        double draw_grain(std::mt19937_64& gen) const;
+
+        workload_parameters params_;
+        double grain_size_;
+        std::vector<std::uint64_t> work_;
+        // Empty if all tasks arrive at once
+        std::vector<std::uint64_t> arrivals_;
+    };
+
+    namespace detail {
+
+        // Uniform in [0, 1)
+        inline double uniform_real(std::mt19937_64& gen)
+        {
+            return static_cast<double>(gen() >> 11) * 0x1.0p-53;
+        }
+    }    // namespace detail
+
+    inline workload::workload(std::uint64_t num_tasks, double grain_size,
+        workload_parameters const& params)
+      : params_(params)
+      , grain_size_(grain_size)
+    {
+        std::mt19937_64 gen(params_.seed);
+
+        work_.reserve(num_tasks);
+        for (std::uint64_t i = 0; i != num_tasks; ++i)
+            work_.push_back(work_for(draw_grain(gen)));
+
+        if (params_.arrival == arrival_process::all_at_once)
+            return;
+
+        arrivals_.reserve(num_tasks);
+        double time = 0.0;
+        for (std::uint64_t i = 0; i != num_tasks; ++i)
+        {
+            if (params_.arrival == arrival_process::poisson)
+            {
+                // Exponential inter-arrival times
+                time -= std::log1p(-detail::uniform_real(gen)) /
+                    params_.arrival_rate * 1e9;
+            }
+            else
+            {
+                time = static_cast<double>(i / params_.burst_size) *
+                    params_.burst_period * 1e3;
+            }
+            arrivals_.push_back(static_cast<std::uint64_t>(time));
+        }
+    }
+
+    inline double workload::draw_grain(std::mt19937_64& gen) const
+    {
+        double const mean = grain_size_;
+        switch (params_.grain)
+        {
+        case grain_distribution::uniform:
+            return 2.0 * mean * detail::uniform_real(gen);
+
+        case grain_distribution::exponential:
+            return -mean * std::log1p(-detail::uniform_real(gen));
+
+        case grain_distribution::bimodal:
+        {
+            double const p = params_.bimodal_fraction;
+            double const ratio = params_.bimodal_ratio;
+            double const short_grain = mean / (1.0 - p + p * ratio);
+            return detail::uniform_real(gen) < p ? short_grain * ratio :
+                                                   short_grain;
+        }
+
+        case grain_distribution::pareto:
+        {
+            double const alpha = params_.pareto_shape;
+            double const scale = mean * (alpha - 1.0) / alpha;
+            return scale /
+                std::pow(1.0 - detail::uniform_real(gen), 1.0 / alpha);
+        }
+
+        case grain_distribution::constant:
+            break;
+        }
+        return mean;
+    }
+
+    // Shows up in the arguments of the benchmark reports
+    inline std::ostream& operator<<(std::ostream& os, workload const& w)
+    {
+        workload_parameters const& params = w.params_;
+
+        os << w.size() << " tasks, " << name_of(params.grain) << " grain of "
+           << w.grain_size_ << " us";
+        if (params.grain == grain_distribution::bimodal)
+        {
+            os << " (" << params.bimodal_fraction << " of them "
+               << params.bimodal_ratio << "x longer)";
+        }
+        else if (params.grain == grain_distribution::pareto)
+        {
+            os << " (shape " << params.pareto_shape << ")";
+        }
+
+        os << ", " << name_of(params.arrival) << " arrival";
+        if (params.arrival == arrival_process::poisson)
+        {
+            os << " (" << params.arrival_rate << " per s)";
+        }
+        else if (params.arrival == arrival_process::bursts)
+        {
+            os << " (" << params.burst_size << " every "
+               << params.burst_period << " us)";
+        }
+
+        return os << ", seed " << params.seed;
+    }
+}}    // namespace locks::util
@@ -3,162 +3,170 @@
 #include <locks.hpp>
 #include <util/benchmark.hpp>
 
-#include <hpx/chrono.hpp>
-#include <hpx/hpx_init.hpp>
-#include <hpx/include/async.hpp>
-#include <hpx/modules/futures.hpp>
+#if LOCKS_WITH_HPX
 #include <hpx/modules/lcos_local.hpp>
+#include <hpx/modules/synchronization.hpp>
+#endif
 
 #include <cstdint>
+#include <iostream>
+#include <mutex>
 #include <string>
 #include <tuple>
 
 ////////////////////////////////////////////////////////////////////////////////
+// Task i waits for its arrival and then does load.work(i) iterations of the
+// calibrated kernel of util/work.hpp, see util/workload.hpp. Every critical
+// section reads and writes the shared_lines cache lines of data, which the
+// next holder of the lock has to fetch. With --shared-lines 0 only the lock
+// itself moves between the workers.
 template <typename LockType>
 struct critical_cases
 {
-    void base_case(std::uint64_t grain_size)
+    critical_cases(
+        locks::util::workload const& load, std::uint64_t shared_lines)
+      : load(load)
+      , data(shared_lines)
     {
-        // Do artificial work for grain_size
-        hpx::chrono::high_resolution_timer t;
-        while (t.elapsed() * 1e6 < grain_size)
-        {
-        }
+    }
+
+    void base_case(std::uint64_t i)
+    {
+        locks::util::spin_work(arrive(i));
     }
 
     ////////////////////////////////////////////////////////////////////////////
     // Critical_small does absolutely minimum work in the critical section
     // making it adequate to compare with situation where atomicity is expected
     // from a minor code section.
-    void critical_small(std::uint64_t grain_size)
+    void critical_small(std::uint64_t i)
     {
-        // Do artificial work for grain_size
-        hpx::chrono::high_resolution_timer t;
-        while (t.elapsed() * 1e6 < grain_size)
-        {
-        }
-
-        std::lock_guard<LockType> guard(lock);
-        ++counter;
+        locks::util::spin_work(arrive(i));
+
+        locks::util::critical_section(lock, [this] { data.update(); });
     }
 
     ////////////////////////////////////////////////////////////////////////////
     // Critical_med does half the work in the critical section making it
     // adequate to compare with parallel graph algorithms where decent chunk of
-    //  work is done under locked conditions.
-    void critical_med(std::uint64_t grain_size)
+    //  work is done under locked conditions. graph.cpp runs actual graph
+    // kernels with a lock per vertex.
+    void critical_med(std::uint64_t i)
     {
-        // Do artificial work for grain_size/2
-        hpx::chrono::high_resolution_timer t1;
-        while (t1.elapsed() * 1e6 < (grain_size / 2))
-        {
-        }
-
-        std::lock_guard<LockType> guard(lock);
-        ++counter;
-        // Do artificial work for 50us
-        hpx::chrono::high_resolution_timer t2;
-        while (t2.elapsed() * 1e6 < (grain_size / 2))
-        {
-        }
+        std::uint64_t const work = arrive(i);
+        locks::util::spin_work(work / 2);
+
+        locks::util::critical_section(lock, [this, work] {
+            data.update();
+            locks::util::spin_work(work - work / 2);
+        });
     }
 
     ////////////////////////////////////////////////////////////////////////////
     // Critical_big does all of its work in the critical section making it
     // adequate to compare with lock-based queues/linked-lists where majority of
     //  the code is under locks.
-    void critical_big(std::uint64_t grain_size)
+    void critical_big(std::uint64_t i)
     {
-        std::lock_guard<LockType> guard(lock);
-        ++counter;
-
-        // Do artificial work for grain_size
-        hpx::chrono::high_resolution_timer t;
-        while (t.elapsed() * 1e6 < grain_size)
-        {
-        }
+        std::uint64_t const work = arrive(i);
+        locks::util::critical_section(lock, [this, work] {
+            data.update();
+            locks::util::spin_work(work);
+        });
     }
 
 private:
-    std::uint64_t counter{};
+    // Waits for task i to arrive, returns its kernel iterations
+    std::uint64_t arrive(std::uint64_t i) const
+    {
+        load.wait_for_arrival(i, start);
+        return load.work(i);
+    }
+
+    locks::util::workload const& load;
+    std::uint64_t const start{locks::platform::now()};
+    locks::util::shared_data data;
     LockType lock{};
 };
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
-void no_locks(std::uint64_t num_tasks, std::uint64_t grain_size)
+void no_locks(locks::util::workload const& load, std::uint64_t shared_lines)
 {
-    std::vector<hpx::future<void>> futures;
-    futures.reserve(num_tasks);
-
-    critical_cases<hpx::lcos::local::spinlock> cases;
+    critical_cases<locks::TAS_lock> cases(load, shared_lines);
 
-    for (std::uint64_t i = 0ul; i != num_tasks; ++i)
-        futures.emplace_back(
-            hpx::async(&critical_cases<hpx::lcos::local::spinlock>::base_case,
-                &cases, grain_size));
-
-    hpx::wait_all(futures);
+    locks::util::run_tasks(load.size(), [&cases](std::uint64_t i) {
+        cases.base_case(i);
+    });
 }
 ////////////////////////////////////////////////////////////////////////////////
 
 ////////////////////////////////////////////////////////////////////////////////
 template <typename LockType>
-void critical_small(std::uint64_t num_tasks, std::uint64_t grain_size)
+void critical_small(
+    locks::util::workload const& load, std::uint64_t shared_lines)
 {
-    std::vector<hpx::future<void>> futures;
-    futures.reserve(num_tasks);
-
-    critical_cases<LockType> cases;
+    critical_cases<LockType> cases(load, shared_lines);
 
-    for (std::uint64_t i = 0ul; i != num_tasks; ++i)
-        futures.emplace_back(hpx::async(
-            &critical_cases<LockType>::critical_small, &cases, grain_size));
-
-    hpx::wait_all(futures);
+    locks::util::run_tasks(load.size(), [&cases](std::uint64_t i) {
+        cases.critical_small(i);
+    });
 }
 
 template <typename LockType>
-void critical_med(std::uint64_t num_tasks, std::uint64_t grain_size)
+void critical_med(locks::util::workload const& load, std::uint64_t shared_lines)
 {
-    std::vector<hpx::future<void>> futures;
-    futures.reserve(num_tasks);
-
-    critical_cases<LockType> cases;
-
-    for (std::uint64_t i = 0ul; i != num_tasks; ++i)
-        futures.emplace_back(hpx::async(
-            &critical_cases<LockType>::critical_med, &cases, grain_size));
+    critical_cases<LockType> cases(load, shared_lines);
 
-    hpx::wait_all(futures);
+    locks::util::run_tasks(load.size(), [&cases](std::uint64_t i) {
+        cases.critical_med(i);
+    });
 }
 
 template <typename LockType>
-void critical_big(std::uint64_t num_tasks, std::uint64_t grain_size)
+void critical_big(locks::util::workload const& load, std::uint64_t shared_lines)
 {
-    std::vector<hpx::future<void>> futures;
-    futures.reserve(num_tasks);
+    critical_cases<LockType> cases(load, shared_lines);
 
-    critical_cases<LockType> cases;
-
-    for (std::uint64_t i = 0ul; i != num_tasks; ++i)
-        futures.emplace_back(hpx::async(
-            &critical_cases<LockType>::critical_big, &cases, grain_size));
-
-    hpx::wait_all(futures);
+    locks::util::run_tasks(load.size(), [&cases](std::uint64_t i) {
+        cases.critical_big(i);
+    });
 }
 ////////////////////////////////////////////////////////////////////////////////
 
-int hpx_main(hpx::program_options::variables_map& vm)
+// Overhead of the contention counters
+using Instrumented_TTAS_lock = locks::instrumented<locks::TTAS_lock>;
+using Instrumented_MCS_lock = locks::instrumented<locks::MCS_lock>;
+
+int benchmark_main(locks::util::program_options::variables_map& vm)
 {
     std::uint64_t num_tasks = vm["num-tasks"].as<std::uint64_t>();
     std::uint64_t grain_size = vm["grain-size"].as<std::uint64_t>();
+    std::uint64_t shared_lines = vm["shared-lines"].as<std::uint64_t>();
 
-    locks::util::benchmark_invoker invoker{num_tasks, grain_size};
+    if (!locks::util::configure_locks(vm))
+        return 1;
+    locks::util::configure_benchmark(vm);
+    if (!locks::util::configure_workload(vm))
+        return 1;
+    locks::util::calibrate_work();
+
+    // Drawn once, every entry runs the same tasks
+    locks::util::workload const load(
+        num_tasks, static_cast<double>(grain_size));
+
+    std::cout << "Work kernel: " << locks::util::work_config().iterations_per_us
+              << " iterations per us\n"
+              << "Workload: " << load << '\n';
+
+    locks::util::benchmark_invoker invoker{load, shared_lines};
+    invoker.set_operations(num_tasks);
     invoker.invoke(GET_FUNCTION_PAIR(no_locks),
+#if LOCKS_WITH_HPX
         GET_FUNCTION_PAIR(critical_small<hpx::lcos::local::spinlock>),
         GET_FUNCTION_PAIR(critical_med<hpx::lcos::local::spinlock>),
         GET_FUNCTION_PAIR(critical_big<hpx::lcos::local::spinlock>),
+#endif
         GET_FUNCTION_PAIR(critical_small<locks::TAS_lock>),
         GET_FUNCTION_PAIR(critical_med<locks::TAS_lock>),
         GET_FUNCTION_PAIR(critical_big<locks::TAS_lock>),
@@ -182,28 +190,88 @@ int hpx_main(hpx::program_options::variables_map& vm)
         GET_FUNCTION_PAIR(critical_big<locks::CLH_lock>),
         GET_FUNCTION_PAIR(critical_small<locks::CLH_BO_lock>),
         GET_FUNCTION_PAIR(critical_med<locks::CLH_BO_lock>),
-        GET_FUNCTION_PAIR(critical_big<locks::CLH_BO_lock>)
+        GET_FUNCTION_PAIR(critical_big<locks::CLH_BO_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::CLH_RC_BO_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::CLH_RC_BO_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::CLH_RC_BO_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::Ticket_BO_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::Ticket_BO_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::Ticket_BO_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::Partitioned_ticket_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::Partitioned_ticket_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::Partitioned_ticket_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::Partitioned_ticket_BO_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::Partitioned_ticket_BO_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::Partitioned_ticket_BO_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::Anderson_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::Anderson_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::Anderson_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::C_TKT_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::C_TKT_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::C_TKT_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::C_BO_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::C_BO_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::C_BO_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::C_MCS_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::C_MCS_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::C_MCS_MCS_lock>),
+#if LOCKS_WITH_HPX
+        GET_FUNCTION_PAIR(critical_small<hpx::lcos::local::mutex>),
+        GET_FUNCTION_PAIR(critical_med<hpx::lcos::local::mutex>),
+        GET_FUNCTION_PAIR(critical_big<hpx::lcos::local::mutex>),
+#else
+        GET_FUNCTION_PAIR(critical_small<std::mutex>),
+        GET_FUNCTION_PAIR(critical_med<std::mutex>),
+        GET_FUNCTION_PAIR(critical_big<std::mutex>),
+#endif
+        GET_FUNCTION_PAIR(critical_small<locks::Parking_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::Parking_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::Parking_lock>),
+        GET_FUNCTION_PAIR(critical_small<Instrumented_TTAS_lock>),
+        GET_FUNCTION_PAIR(critical_med<Instrumented_TTAS_lock>),
+        GET_FUNCTION_PAIR(critical_big<Instrumented_TTAS_lock>),
+        GET_FUNCTION_PAIR(critical_small<Instrumented_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_med<Instrumented_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_big<Instrumented_MCS_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::Flat_combining_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::Flat_combining_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::Flat_combining_lock>),
+        GET_FUNCTION_PAIR(critical_small<locks::Delegation_lock>),
+        GET_FUNCTION_PAIR(critical_med<locks::Delegation_lock>),
+        GET_FUNCTION_PAIR(critical_big<locks::Delegation_lock>)
         //
     );
 
-    return hpx::finalize();    // Handles HPX shutdown
+    return 0;
 }
 
 int main(int argc, char* argv[])
 {
-    hpx::program_options::options_description desc_commandline(
-        "Usage: " HPX_APPLICATION_STRING " [options]");
+    locks::util::program_options::options_description desc_commandline(
+        std::string("Usage: ") + argv[0] + " [options]");
 
     desc_commandline.add_options()("num-tasks",
-        hpx::program_options::value<std::uint64_t>()->default_value(10000),
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            10000),
         "Number of tasks to launch");
     desc_commandline.add_options()("grain-size",
-        hpx::program_options::value<std::uint64_t>()->default_value(100),
-        "Grain size of each task");
-
-    // Initialize and run HPX
-    hpx::init_params init_args;
-    init_args.desc_cmdline = desc_commandline;
-
-    return hpx::init(argc, argv, init_args);
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            100),
+        "Mean grain size of the tasks (in us)");
+    desc_commandline.add_options()("shared-lines",
+        locks::util::program_options::value<std::uint64_t>()->default_value(1),
+        "Number of shared cache lines every critical section writes");
+
+    desc_commandline.add(locks::util::lock_options());
+    desc_commandline.add(locks::util::workload_options());
+    desc_commandline.add(locks::util::benchmark_options());
+
+    return locks::util::run_benchmark(
+        argc, argv, desc_commandline, benchmark_main);
 }
@@ -0,0 +1,357 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#include <locks.hpp>
+#include <util/benchmark.hpp>
+
+#if LOCKS_WITH_HPX
+#include <hpx/modules/lcos_local.hpp>
+#include <hpx/modules/synchronization.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Undirected graph in compressed sparse row form, every edge shows up in the
+// neighbor lists of both of its endpoints.
+struct graph
+{
+    std::uint64_t num_vertices() const
+    {
+        return offsets.size() - 1;
+    }
+
+    std::uint64_t num_edges() const
+    {
+        return edges.size();
+    }
+
+    std::string kind;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::uint32_t> neighbors;
+
+    // Vertex of the highest degree, the BFS starts from it to reach the
+    // largest component
+    std::uint32_t root{0};
+};
+
+// Shows up as the argument of the benchmark entries in the reports
+std::ostream& operator<<(std::ostream& os, graph const& g)
+{
+    return os << g.kind << " graph, " << g.num_vertices() << " vertices, "
+              << g.num_edges() << " edges";
+}
+
+// R-MAT (Chakrabarti et al.) with the Graph500 parameters: every edge picks
+// one quadrant of the adjacency matrix per bit of the vertex ids, giving the
+// skewed degree distribution of social and web graphs. The vertex ids are
+// permuted so that the high-degree vertices do not cluster at the start of
+// the lock array.
+std::vector<std::pair<std::uint32_t, std::uint32_t>> rmat_edges(
+    std::uint64_t scale, std::uint64_t num_edges, std::mt19937_64& gen)
+{
+    double const a = 0.57, b = 0.19, c = 0.19;
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    std::vector<std::uint32_t> permutation(std::uint64_t(1) << scale);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::shuffle(permutation.begin(), permutation.end(), gen);
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    edges.reserve(num_edges);
+    for (std::uint64_t i = 0; i != num_edges; ++i)
+    {
+        std::uint32_t u = 0, v = 0;
+        for (std::uint64_t bit = 0; bit != scale; ++bit)
+        {
+            double const r = dist(gen);
+            u = (u << 1) | (r >= a + b ? 1 : 0);
+            v = (v << 1) | ((r >= a && r < a + b) || r >= a + b + c ? 1 : 0);
+        }
+        edges.emplace_back(permutation[u], permutation[v]);
+    }
+    return edges;
+}
+
+// Endpoints drawn uniformly, every vertex has about the same degree
+std::vector<std::pair<std::uint32_t, std::uint32_t>> uniform_edges(
+    std::uint64_t scale, std::uint64_t num_edges, std::mt19937_64& gen)
+{
+    std::uniform_int_distribution<std::uint32_t> dist(
+        0, static_cast<std::uint32_t>((std::uint64_t(1) << scale) - 1));
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    edges.reserve(num_edges);
+    for (std::uint64_t i = 0; i != num_edges; ++i)
+        edges.emplace_back(dist(gen), dist(gen));
+    return edges;
+}
+
+// 2^scale vertices and edge_factor edges per vertex, without self loops.
+// Duplicate edges are kept, as in Graph500.
+graph generate_graph(std::string const& kind, std::uint64_t scale,
+    std::uint64_t edge_factor, std::uint64_t seed)
+{
+    std::mt19937_64 gen(seed);
+    std::uint64_t const n = std::uint64_t(1) << scale;
+
+    graph g;
+    g.kind = kind;
+    if (kind == "rmat")
+        g.edges = rmat_edges(scale, n * edge_factor, gen);
+    else
+        g.edges = uniform_edges(scale, n * edge_factor, gen);
+
+    g.edges.erase(std::remove_if(g.edges.begin(), g.edges.end(),
+                      [](auto const& e) { return e.first == e.second; }),
+        g.edges.end());
+
+    std::vector<std::uint64_t> degree(n, 0);
+    for (auto const& [u, v] : g.edges)
+    {
+        ++degree[u];
+        ++degree[v];
+    }
+
+    g.offsets.assign(n + 1, 0);
+    std::partial_sum(degree.begin(), degree.end(), g.offsets.begin() + 1);
+
+    std::vector<std::uint64_t> fill(g.offsets.begin(), g.offsets.end() - 1);
+    g.neighbors.resize(g.offsets.back());
+    for (auto const& [u, v] : g.edges)
+    {
+        g.neighbors[fill[u]++] = v;
+        g.neighbors[fill[v]++] = u;
+    }
+
+    g.root = static_cast<std::uint32_t>(
+        std::max_element(degree.begin(), degree.end()) - degree.begin());
+    return g;
+}
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// Every vertex has a lock of its own, so there are as many locks as vertices
+// and two tasks rarely want the same one. Allocating the locks is part of
+// the measurement: with this many locks their size and cache footprint
+// dominate, not their behavior under contention. The vertex locks are taken
+// with std::lock_guard rather than util::critical_section(), whose --latency
+// recording assumes a single lock.
+constexpr std::uint32_t no_parent = ~std::uint32_t(0);
+
+////////////////////////////////////////////////////////////////////////////////
+// Level-synchronous top-down BFS. The lock of a vertex guards its parent,
+// every edge out of the frontier locks its target to claim it.
+template <typename LockType>
+void bfs(graph const& g)
+{
+    std::uint64_t const n = g.num_vertices();
+    std::unique_ptr<LockType[]> vertex_locks(new LockType[n]);
+    std::vector<std::uint32_t> parent(n, no_parent);
+
+    std::vector<std::uint32_t> frontier{g.root};
+    std::vector<std::uint32_t> next(n);
+    parent[g.root] = g.root;
+
+    while (!frontier.empty())
+    {
+        std::atomic<std::uint64_t> next_size{0};
+
+        locks::util::parallel_for(frontier.size(), [&](std::uint64_t i) {
+            std::uint32_t const u = frontier[i];
+            for (std::uint64_t e = g.offsets[u]; e != g.offsets[u + 1]; ++e)
+            {
+                std::uint32_t const v = g.neighbors[e];
+
+                bool claimed = false;
+                {
+                    std::lock_guard<LockType> guard(vertex_locks[v]);
+                    if (parent[v] == no_parent)
+                    {
+                        parent[v] = u;
+                        claimed = true;
+                    }
+                }
+
+                if (claimed)
+                    next[next_size.fetch_add(1, std::memory_order_relaxed)] =
+                        v;
+            }
+        });
+
+        frontier.assign(next.begin(), next.begin() + next_size.load());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Connected components by union-find over the edge list. Roots are only
+// ever linked below a root of a smaller id, so the forest stays acyclic
+// without locking both roots: the lock of the larger root guards its
+// linking, find() halves paths without locks.
+template <typename LockType>
+void connected_components(graph const& g)
+{
+    std::uint64_t const n = g.num_vertices();
+    std::unique_ptr<LockType[]> vertex_locks(new LockType[n]);
+    std::unique_ptr<std::atomic<std::uint32_t>[]> parent(
+        new std::atomic<std::uint32_t>[n]);
+    for (std::uint64_t v = 0; v != n; ++v)
+        parent[v].store(static_cast<std::uint32_t>(v));
+
+    auto find = [&parent](std::uint32_t v) {
+        std::uint32_t p = parent[v].load(std::memory_order_acquire);
+        while (p != v)
+        {
+            // Only non-roots are shortcut, linking only changes roots
+            std::uint32_t const grandparent =
+                parent[p].load(std::memory_order_acquire);
+            parent[v].compare_exchange_weak(
+                p, grandparent, std::memory_order_acq_rel);
+            v = p;
+            p = parent[v].load(std::memory_order_acquire);
+        }
+        return v;
+    };
+
+    locks::util::parallel_for(g.num_edges(), [&](std::uint64_t i) {
+        auto const [u, v] = g.edges[i];
+        while (true)
+        {
+            std::uint32_t root_u = find(u);
+            std::uint32_t root_v = find(v);
+            if (root_u == root_v)
+                return;
+            if (root_u > root_v)
+                std::swap(root_u, root_v);
+
+            bool linked = false;
+            {
+                std::lock_guard<LockType> guard(vertex_locks[root_v]);
+                // Someone else may have linked it in the meantime
+                if (parent[root_v].load(std::memory_order_relaxed) == root_v)
+                {
+                    parent[root_v].store(root_u, std::memory_order_release);
+                    linked = true;
+                }
+            }
+
+            if (linked)
+                return;
+        }
+    });
+}
+////////////////////////////////////////////////////////////////////////////////
+
+// Every lock on its own cache line
+using Padded_TTAS_lock =
+    locks::basic_TTAS_lock<locks::policy::pause, locks::policy::padded>;
+using Padded_Ticket_lock =
+    locks::basic_Ticket_lock<locks::policy::pause, locks::policy::padded>;
+using Padded_MCS_lock =
+    locks::basic_MCS_lock<locks::policy::pause, locks::policy::padded>;
+
+int benchmark_main(locks::util::program_options::variables_map& vm)
+{
+    std::uint64_t scale = vm["scale"].as<std::uint64_t>();
+    std::uint64_t edge_factor = vm["edge-factor"].as<std::uint64_t>();
+    std::uint64_t seed = vm["seed"].as<std::uint64_t>();
+    std::string kind = vm["graph"].as<std::string>();
+
+    if (kind != "rmat" && kind != "uniform")
+    {
+        std::cerr << "--graph must be rmat or uniform\n";
+        return 1;
+    }
+    if (scale == 0 || scale > 31)
+    {
+        std::cerr << "--scale must be in [1, 31]\n";
+        return 1;
+    }
+
+    if (!locks::util::configure_locks(vm))
+        return 1;
+    locks::util::configure_benchmark(vm);
+
+    graph g = generate_graph(kind, scale, edge_factor, seed);
+    std::uint64_t const num_edges = g.num_edges();
+    std::cout << g << '\n';
+
+    // Throughput is in (input) edges per second
+    locks::util::benchmark_invoker invoker{std::move(g)};
+    invoker.set_operations(num_edges);
+    invoker.invoke(
+#if LOCKS_WITH_HPX
+        GET_FUNCTION_PAIR(bfs<hpx::lcos::local::spinlock>),
+        GET_FUNCTION_PAIR(bfs<hpx::lcos::local::mutex>),
+#else
+        GET_FUNCTION_PAIR(bfs<std::mutex>),
+#endif
+        GET_FUNCTION_PAIR(bfs<locks::TAS_lock>),
+        GET_FUNCTION_PAIR(bfs<locks::TTAS_lock>),
+        GET_FUNCTION_PAIR(bfs<Padded_TTAS_lock>),
+        GET_FUNCTION_PAIR(bfs<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(bfs<Padded_Ticket_lock>),
+        GET_FUNCTION_PAIR(bfs<locks::MCS_lock>),
+        GET_FUNCTION_PAIR(bfs<Padded_MCS_lock>),
+        GET_FUNCTION_PAIR(bfs<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(bfs<locks::Parking_lock>),
+#if LOCKS_WITH_HPX
+        GET_FUNCTION_PAIR(connected_components<hpx::lcos::local::spinlock>),
+        GET_FUNCTION_PAIR(connected_components<hpx::lcos::local::mutex>),
+#else
+        GET_FUNCTION_PAIR(connected_components<std::mutex>),
+#endif
+        GET_FUNCTION_PAIR(connected_components<locks::TAS_lock>),
+        GET_FUNCTION_PAIR(connected_components<locks::TTAS_lock>),
+        GET_FUNCTION_PAIR(connected_components<Padded_TTAS_lock>),
+        GET_FUNCTION_PAIR(connected_components<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(connected_components<Padded_Ticket_lock>),
+        GET_FUNCTION_PAIR(connected_components<locks::MCS_lock>),
+        GET_FUNCTION_PAIR(connected_components<Padded_MCS_lock>),
+        GET_FUNCTION_PAIR(connected_components<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(connected_components<locks::Parking_lock>)
+        //
+    );
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    locks::util::program_options::options_description desc_commandline(
+        std::string("Usage: ") + argv[0] + " [options]");
+
+    desc_commandline.add_options()("graph",
+        locks::util::program_options::value<std::string>()->default_value(
+            "rmat"),
+        "Kind of the generated graph: rmat or uniform");
+    desc_commandline.add_options()("scale",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            16),
+        "Log2 of the number of vertices");
+    desc_commandline.add_options()("edge-factor",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            16),
+        "Number of edges per vertex");
+    desc_commandline.add_options()("seed",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            0),
+        "Seed of the graph generator");
+
+    desc_commandline.add(locks::util::lock_options());
+    desc_commandline.add(locks::util::benchmark_options());
+
+    return locks::util::run_benchmark(
+        argc, argv, desc_commandline, benchmark_main);
+}
@@ -0,0 +1,266 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#include <locks.hpp>
+#include <util/benchmark.hpp>
+
+#if LOCKS_WITH_HPX
+#include <hpx/modules/synchronization.hpp>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ds {
+
+    // Hash map with a fixed number of buckets, guarded by a
+    // locks::striped_lock. All keys of a bucket share its stripe, so
+    // operations on buckets of different stripes run concurrently.
+    template <typename Key, typename Value, typename StripedLock>
+    class HashMap
+    {
+    public:
+        explicit HashMap(std::size_t bucket_count)
+          : buckets_(bucket_count)
+        {
+        }
+
+        bool find(Key const& key, Value& value)
+        {
+            std::size_t const b = bucket_of(key);
+            auto guard = locks_.lock_keys(b);
+
+            for (auto const& entry : buckets_[b])
+            {
+                if (entry.first == key)
+                {
+                    value = entry.second;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Returns false and leaves the map unchanged if key is present
+        bool insert(Key const& key, Value const& value)
+        {
+            std::size_t const b = bucket_of(key);
+            auto guard = locks_.lock_keys(b);
+
+            for (auto const& entry : buckets_[b])
+            {
+                if (entry.first == key)
+                    return false;
+            }
+            buckets_[b].emplace_back(key, value);
+            return true;
+        }
+
+        bool erase(Key const& key)
+        {
+            std::size_t const b = bucket_of(key);
+            auto guard = locks_.lock_keys(b);
+
+            bucket& entries = buckets_[b];
+            for (auto& entry : entries)
+            {
+                if (entry.first == key)
+                {
+                    entry = std::move(entries.back());
+                    entries.pop_back();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Swaps the values of both keys atomically, false unless both are
+        // present. Holds the stripes of both buckets at once.
+        bool exchange(Key const& first, Key const& second)
+        {
+            std::size_t const b1 = bucket_of(first);
+            std::size_t const b2 = bucket_of(second);
+            auto guard = locks_.lock_keys(b1, b2);
+
+            Value* v1 = lookup(b1, first);
+            Value* v2 = lookup(b2, second);
+            if (v1 == nullptr || v2 == nullptr)
+                return false;
+
+            std::swap(*v1, *v2);
+            return true;
+        }
+
+    private:
+        using bucket = std::vector<std::pair<Key, Value>>;
+
+        std::size_t bucket_of(Key const& key) const
+        {
+            return std::hash<Key>{}(key) % buckets_.size();
+        }
+
+        Value* lookup(std::size_t b, Key const& key)
+        {
+            for (auto& entry : buckets_[b])
+            {
+                if (entry.first == key)
+                    return &entry.second;
+            }
+            return nullptr;
+        }
+
+        std::vector<bucket> buckets_;
+        StripedLock locks_;
+    };
+
+}    // namespace ds
+
+////////////////////////////////////////////////////////////////////////////////
+// SplitMix64 finalizer, picks the key and the kind of every operation
+// without shared generator state
+std::uint64_t mix(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// The map starts out empty and has as many buckets as keys. Every
+// operation draws a key, read_percent of them are lookups and
+// exchange_percent swap the values of two keys, the rest are split evenly
+// between inserts and erases.
+template <typename StripedLock>
+void hash_map(std::uint64_t num_operations, std::uint64_t num_keys,
+    std::uint64_t read_percent, std::uint64_t exchange_percent)
+{
+    ds::HashMap<std::uint64_t, std::uint64_t, StripedLock> map(num_keys);
+
+    locks::util::parallel_for(num_operations, [&](std::uint64_t i) {
+        std::uint64_t const r = mix(i);
+        std::uint64_t const key = r % num_keys;
+        std::uint64_t const kind = (r >> 32) % 100;
+
+        if (kind < read_percent)
+        {
+            std::uint64_t value;
+            map.find(key, value);
+        }
+        else if (kind < read_percent + exchange_percent)
+        {
+            map.exchange(key, mix(r) % num_keys);
+        }
+        else if (kind % 2 == 0)
+        {
+            map.insert(key, i);
+        }
+        else
+        {
+            map.erase(key);
+        }
+    });
+}
+
+// A single stripe is one global lock
+template <std::size_t N>
+using TTAS_stripes = locks::striped_lock<locks::TTAS_lock, N>;
+template <std::size_t N>
+using Ticket_stripes = locks::striped_lock<locks::Ticket_lock, N>;
+template <std::size_t N>
+using MCS_stripes = locks::striped_lock<locks::MCS_lock, N>;
+template <std::size_t N>
+using CLH_stripes = locks::striped_lock<locks::CLH_lock, N>;
+template <std::size_t N>
+using Parking_stripes = locks::striped_lock<locks::Parking_lock, N>;
+#if LOCKS_WITH_HPX
+template <std::size_t N>
+using Mutex_stripes = locks::striped_lock<hpx::lcos::local::mutex, N>;
+#else
+template <std::size_t N>
+using Mutex_stripes = locks::striped_lock<std::mutex, N>;
+#endif
+
+int benchmark_main(locks::util::program_options::variables_map& vm)
+{
+    std::uint64_t num_operations = vm["num-operations"].as<std::uint64_t>();
+    std::uint64_t num_keys = vm["num-keys"].as<std::uint64_t>();
+    std::uint64_t read_percent = vm["read-percent"].as<std::uint64_t>();
+    std::uint64_t exchange_percent =
+        vm["exchange-percent"].as<std::uint64_t>();
+
+    if (num_keys == 0)
+    {
+        std::cerr << "--num-keys must not be 0\n";
+        return 1;
+    }
+    if (read_percent + exchange_percent > 100)
+    {
+        std::cerr << "--read-percent and --exchange-percent must not add up "
+                     "to more than 100\n";
+        return 1;
+    }
+
+    if (!locks::util::configure_locks(vm))
+        return 1;
+    locks::util::configure_benchmark(vm);
+
+    locks::util::benchmark_invoker invoker{
+        num_operations, num_keys, read_percent, exchange_percent};
+    invoker.set_operations(num_operations);
+    invoker.invoke(GET_FUNCTION_PAIR(hash_map<MCS_stripes<1>>),
+        GET_FUNCTION_PAIR(hash_map<TTAS_stripes<16>>),
+        GET_FUNCTION_PAIR(hash_map<Ticket_stripes<16>>),
+        GET_FUNCTION_PAIR(hash_map<MCS_stripes<16>>),
+        GET_FUNCTION_PAIR(hash_map<CLH_stripes<16>>),
+        GET_FUNCTION_PAIR(hash_map<Parking_stripes<16>>),
+        GET_FUNCTION_PAIR(hash_map<Mutex_stripes<16>>),
+        GET_FUNCTION_PAIR(hash_map<TTAS_stripes<256>>),
+        GET_FUNCTION_PAIR(hash_map<Ticket_stripes<256>>),
+        GET_FUNCTION_PAIR(hash_map<MCS_stripes<256>>),
+        GET_FUNCTION_PAIR(hash_map<CLH_stripes<256>>),
+        GET_FUNCTION_PAIR(hash_map<Parking_stripes<256>>),
+        GET_FUNCTION_PAIR(hash_map<Mutex_stripes<256>>),
+        GET_FUNCTION_PAIR(hash_map<TTAS_stripes<4096>>),
+        GET_FUNCTION_PAIR(hash_map<Ticket_stripes<4096>>),
+        GET_FUNCTION_PAIR(hash_map<MCS_stripes<4096>>),
+        GET_FUNCTION_PAIR(hash_map<CLH_stripes<4096>>),
+        GET_FUNCTION_PAIR(hash_map<Parking_stripes<4096>>),
+        GET_FUNCTION_PAIR(hash_map<Mutex_stripes<4096>>)
+        //
+    );
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    locks::util::program_options::options_description desc_commandline(
+        std::string("Usage: ") + argv[0] + " [options]");
+
+    desc_commandline.add_options()("num-operations",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            100000),
+        "Number of map operations");
+    desc_commandline.add_options()("num-keys",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            65536),
+        "Number of distinct keys, also the number of buckets");
+    desc_commandline.add_options()("read-percent",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            80),
+        "Percentage of lookups");
+    desc_commandline.add_options()("exchange-percent",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            5),
+        "Percentage of operations swapping the values of two keys");
+
+    desc_commandline.add(locks::util::lock_options());
+    desc_commandline.add(locks::util::benchmark_options());
+
+    return locks::util::run_benchmark(
+        argc, argv, desc_commandline, benchmark_main);
+}
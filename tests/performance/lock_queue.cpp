@@ -1,23 +1,40 @@
 #include <locks.hpp>
 #include <util/benchmark.hpp>
 
-#include <hpx/hpx_init.hpp>
-#include <hpx/modules/algorithms.hpp>
+#if LOCKS_WITH_HPX
 #include <hpx/modules/lcos_local.hpp>
+#include <hpx/modules/synchronization.hpp>
+#endif
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <type_traits>
+#include <utility>
 
 namespace ds {
 
+    // Queue guarded by a single lock, pushes and pops serialize on it
     template <typename ValueType, typename LockType>
     class Queue
     {
     public:
-        void pop()
+        // Returns false if the queue is empty
+        bool try_pop(ValueType& item)
         {
             std::lock_guard<LockType> mlock(lock_);
+            if (queue_.empty())
+                return false;
+
+            item = std::move(queue_.front());
             queue_.pop();
+            return true;
         }
 
         void push(const ValueType& item)
@@ -31,28 +48,493 @@ namespace ds {
         LockType lock_{};
     };
 
+    // Michael and Scott's two-lock queue. The list always starts with a
+    // dummy node, so pushes only touch the tail and pops only the head:
+    // producers serialize on the tail lock, consumers on the head lock, and
+    // a producer and a consumer never wait for each other.
+    template <typename ValueType, typename LockType>
+    class TwoLockQueue
+    {
+    public:
+        TwoLockQueue()
+          : head_(new node)
+          , tail_(head_)
+        {
+        }
+
+        TwoLockQueue(TwoLockQueue const&) = delete;
+        TwoLockQueue& operator=(TwoLockQueue const&) = delete;
+
+        ~TwoLockQueue()
+        {
+            while (head_ != nullptr)
+            {
+                node* next = head_->next.load(std::memory_order_relaxed);
+                delete head_;
+                head_ = next;
+            }
+        }
+
+        bool try_pop(ValueType& item)
+        {
+            node* old_head;
+            {
+                std::lock_guard<LockType> mlock(head_lock_);
+
+                // Set by a producer that holds the tail lock only
+                node* const first =
+                    head_->next.load(std::memory_order_acquire);
+                if (first == nullptr)
+                    return false;
+
+                item = std::move(first->value);
+                old_head = head_;
+                head_ = first;
+            }
+
+            delete old_head;
+            return true;
+        }
+
+        void push(const ValueType& item)
+        {
+            node* const new_node = new node{item};
+
+            std::lock_guard<LockType> mlock(tail_lock_);
+            tail_->next.store(new_node, std::memory_order_release);
+            tail_ = new_node;
+        }
+
+    private:
+        struct node
+        {
+            ValueType value{};
+            std::atomic<node*> next{nullptr};
+        };
+
+        // Head and tail on cache lines of their own, so that producers and
+        // consumers do not invalidate each other's lock
+        alignas(locks::policy::cache_line_size) LockType head_lock_{};
+        node* head_;
+
+        alignas(locks::policy::cache_line_size) LockType tail_lock_{};
+        node* tail_;
+    };
+
+    ////////////////////////////////////////////////////////////////////////
+    // Lock-free baselines
+
+    // Vyukov's bounded MPMC queue. Every cell carries a sequence number
+    // telling whether it is ready for the push or the pop of a given lap
+    // around the ring, so producers and consumers only contend on their
+    // own position counter. push() fails if the queue is full.
+    template <typename ValueType, std::size_t Capacity>
+    class BoundedQueue
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+            "Capacity must be a power of two");
+
+    public:
+        BoundedQueue()
+          : cells_(new cell[Capacity])
+        {
+            for (std::size_t i = 0; i != Capacity; ++i)
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        bool try_pop(ValueType& item)
+        {
+            std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+            cell* c;
+            while (true)
+            {
+                c = &cells_[pos & (Capacity - 1)];
+                std::size_t const seq =
+                    c->sequence.load(std::memory_order_acquire);
+                std::intptr_t const diff = static_cast<std::intptr_t>(seq) -
+                    static_cast<std::intptr_t>(pos + 1);
+
+                if (diff == 0)
+                {
+                    if (dequeue_pos_.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false;    // empty
+                }
+                else
+                {
+                    pos = dequeue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+
+            item = std::move(c->value);
+
+            // Ready for the push of the next lap
+            c->sequence.store(pos + Capacity, std::memory_order_release);
+            return true;
+        }
+
+        bool push(const ValueType& item)
+        {
+            std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+            cell* c;
+            while (true)
+            {
+                c = &cells_[pos & (Capacity - 1)];
+                std::size_t const seq =
+                    c->sequence.load(std::memory_order_acquire);
+                std::intptr_t const diff = static_cast<std::intptr_t>(seq) -
+                    static_cast<std::intptr_t>(pos);
+
+                if (diff == 0)
+                {
+                    if (enqueue_pos_.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false;    // full
+                }
+                else
+                {
+                    pos = enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+
+            c->value = item;
+            c->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        struct cell
+        {
+            std::atomic<std::size_t> sequence{0};
+            ValueType value{};
+        };
+
+        std::unique_ptr<cell[]> cells_;
+
+        alignas(locks::policy::cache_line_size)
+            std::atomic<std::size_t> enqueue_pos_{0};
+        alignas(locks::policy::cache_line_size)
+            std::atomic<std::size_t> dequeue_pos_{0};
+    };
+
+    // Michael and Scott's lock-free queue. Popped nodes are not freed but
+    // stay linked behind the head until the queue is destroyed: nodes are
+    // never reused, so there is no ABA problem and no hazard pointers are
+    // needed. Good for the lifetime of a benchmark run, not beyond.
+    template <typename ValueType>
+    class LockFreeQueue
+    {
+    public:
+        LockFreeQueue()
+          : first_(new node)
+          , head_(first_)
+          , tail_(first_)
+        {
+        }
+
+        LockFreeQueue(LockFreeQueue const&) = delete;
+        LockFreeQueue& operator=(LockFreeQueue const&) = delete;
+
+        ~LockFreeQueue()
+        {
+            while (first_ != nullptr)
+            {
+                node* next = first_->next.load(std::memory_order_relaxed);
+                delete first_;
+                first_ = next;
+            }
+        }
+
+        bool try_pop(ValueType& item)
+        {
+            while (true)
+            {
+                node* head = head_.load(std::memory_order_acquire);
+                node* tail = tail_.load(std::memory_order_acquire);
+                node* const next = head->next.load(std::memory_order_acquire);
+
+                if (head != head_.load(std::memory_order_acquire))
+                    continue;
+
+                if (next == nullptr)
+                    return false;
+
+                if (head == tail)
+                {
+                    // Help the producer that linked next to swing the tail
+                    tail_.compare_exchange_strong(tail, next,
+                        std::memory_order_release, std::memory_order_relaxed);
+                    continue;
+                }
+
+                // Read before the head moves on, the value is not written
+                // again once the node is linked
+                ValueType value = next->value;
+                if (head_.compare_exchange_strong(head, next,
+                        std::memory_order_acq_rel, std::memory_order_relaxed))
+                {
+                    item = std::move(value);
+                    return true;
+                }
+            }
+        }
+
+        void push(const ValueType& item)
+        {
+            node* const new_node = new node{item};
+
+            while (true)
+            {
+                node* tail = tail_.load(std::memory_order_acquire);
+                node* next = tail->next.load(std::memory_order_acquire);
+
+                if (tail != tail_.load(std::memory_order_acquire))
+                    continue;
+
+                if (next == nullptr)
+                {
+                    if (tail->next.compare_exchange_weak(next, new_node,
+                            std::memory_order_release,
+                            std::memory_order_relaxed))
+                    {
+                        tail_.compare_exchange_strong(tail, new_node,
+                            std::memory_order_release,
+                            std::memory_order_relaxed);
+                        return;
+                    }
+                }
+                else
+                {
+                    // The tail lags behind, help move it
+                    tail_.compare_exchange_strong(tail, next,
+                        std::memory_order_release, std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        struct node
+        {
+            ValueType value{};
+            std::atomic<node*> next{nullptr};
+        };
+
+        // The dummy node the queue started with, every node ever pushed
+        // can be reached from it
+        node* first_;
+
+        alignas(locks::policy::cache_line_size) std::atomic<node*> head_;
+        alignas(locks::policy::cache_line_size) std::atomic<node*> tail_;
+    };
+
+    ////////////////////////////////////////////////////////////////////////
+    // Queue whose operations are handed to a combining lock, the combiner
+    // applies batches of pushes and pops back to back.
+    template <typename ValueType, typename CombiningLock>
+    class CombiningQueue
+    {
+    public:
+        bool try_pop(ValueType& item)
+        {
+            return lock_.execute([this, &item] {
+                if (queue_.empty())
+                    return false;
+
+                item = std::move(queue_.front());
+                queue_.pop();
+                return true;
+            });
+        }
+
+        void push(const ValueType& item)
+        {
+            lock_.execute([this, &item] { queue_.push(item); });
+        }
+
+    private:
+        std::queue<ValueType> queue_{};
+        CombiningLock lock_{};
+    };
+
 }    // namespace ds
 
 ////////////////////////////////////////////////////////////////////////////////
+// Queue element of Size bytes, pushes and pops copy all of them
+template <std::size_t Size>
+struct item
+{
+    static_assert(Size >= sizeof(std::uint64_t));
+
+    item() = default;
+
+    explicit item(std::uint64_t i)
+    {
+        std::memcpy(bytes.data(), &i, sizeof(i));
+    }
+
+    std::array<unsigned char, Size> bytes{};
+};
+
+// Calls f with an item of item_size bytes, false if there is no such item
+template <typename F>
+bool with_item(std::uint64_t item_size, F&& f)
+{
+    switch (item_size)
+    {
+    case 8:
+        f(item<8>{});
+        return true;
+    case 64:
+        f(item<64>{});
+        return true;
+    case 512:
+        f(item<512>{});
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Operation i is a push if it falls within the first producers of every
+// producers + consumers operations, a pop otherwise. The operations are
+// spread over all workers, so every worker both produces and consumes in
+// that ratio. A pop that finds the queue empty counts as an operation of
+// its own, it takes the locks all the same. Every push succeeds, like in
+// the unbounded lock-based queues: a push into a full bounded queue pops an
+// item to make room and tries again.
+template <typename QueueType, typename ValueType>
+void producer_consumer(
+    std::uint64_t num_operations, std::uint64_t producers,
+    std::uint64_t consumers)
+{
+    QueueType queue;
+    std::uint64_t const period = producers + consumers;
+
+    locks::util::parallel_for(num_operations, [&](std::uint64_t i) {
+        if (i % period < producers)
+        {
+            ValueType const value(i);
+            if constexpr (std::is_same_v<decltype(queue.push(value)), bool>)
+            {
+                while (!queue.push(value))
+                {
+                    ValueType dropped;
+                    queue.try_pop(dropped);
+                }
+            }
+            else
+            {
+                queue.push(value);
+            }
+        }
+        else
+        {
+            ValueType value;
+            queue.try_pop(value);
+        }
+    });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Slots of the bounded lock-free queue
+constexpr std::size_t bounded_queue_capacity = 4096;
+
+// Lock-free reference numbers for the lock-based queues below
+void lock_free_queue(std::uint64_t num_operations, std::uint64_t producers,
+    std::uint64_t consumers, std::uint64_t item_size)
+{
+    with_item(item_size, [&](auto value) {
+        using value_type = decltype(value);
+        producer_consumer<ds::LockFreeQueue<value_type>, value_type>(
+            num_operations, producers, consumers);
+    });
+}
+
+void bounded_lock_free_queue(std::uint64_t num_operations,
+    std::uint64_t producers, std::uint64_t consumers, std::uint64_t item_size)
+{
+    with_item(item_size, [&](auto value) {
+        using value_type = decltype(value);
+        producer_consumer<
+            ds::BoundedQueue<value_type, bounded_queue_capacity>, value_type>(
+            num_operations, producers, consumers);
+    });
+}
+
 template <typename LockType>
-void concurrent_queue(std::uint64_t num_push_pop)
+void concurrent_queue(std::uint64_t num_operations, std::uint64_t producers,
+    std::uint64_t consumers, std::uint64_t item_size)
 {
-    ds::Queue<std::uint64_t, LockType> queue;
+    with_item(item_size, [&](auto value) {
+        using value_type = decltype(value);
+        producer_consumer<ds::Queue<value_type, LockType>, value_type>(
+            num_operations, producers, consumers);
+    });
+}
 
-    hpx::for_loop(0ul, num_push_pop,
-        [&queue](std::uint64_t i) { queue.push(std::rand()); });
+template <typename LockType>
+void two_lock_queue(std::uint64_t num_operations, std::uint64_t producers,
+    std::uint64_t consumers, std::uint64_t item_size)
+{
+    with_item(item_size, [&](auto value) {
+        using value_type = decltype(value);
+        producer_consumer<ds::TwoLockQueue<value_type, LockType>, value_type>(
+            num_operations, producers, consumers);
+    });
+}
 
-    hpx::for_loop(
-        0ul, num_push_pop, [&queue](std::uint64_t i) { queue.pop(); });
+template <typename CombiningLock>
+void combining_queue(std::uint64_t num_operations, std::uint64_t producers,
+    std::uint64_t consumers, std::uint64_t item_size)
+{
+    with_item(item_size, [&](auto value) {
+        using value_type = decltype(value);
+        producer_consumer<ds::CombiningQueue<value_type, CombiningLock>,
+            value_type>(num_operations, producers, consumers);
+    });
 }
 
-int hpx_main(hpx::program_options::variables_map& vm)
+using Flat_combining_TAS_BO_lock =
+    locks::basic_Flat_combining_lock<locks::TAS_BO_lock>;
+
+int benchmark_main(locks::util::program_options::variables_map& vm)
 {
-    std::uint64_t num_push_pop = vm["num-push-pop"].as<std::uint64_t>();
+    std::uint64_t num_operations = vm["num-operations"].as<std::uint64_t>();
+    std::uint64_t producers = vm["producers"].as<std::uint64_t>();
+    std::uint64_t consumers = vm["consumers"].as<std::uint64_t>();
+    std::uint64_t item_size = vm["item-size"].as<std::uint64_t>();
+
+    if (producers + consumers == 0)
+    {
+        std::cerr << "--producers and --consumers must not both be 0\n";
+        return 1;
+    }
+    if (!with_item(item_size, [](auto) {}))
+    {
+        std::cerr << "--item-size must be 8, 64 or 512\n";
+        return 1;
+    }
+
+    if (!locks::util::configure_locks(vm))
+        return 1;
+    locks::util::configure_benchmark(vm);
 
-    locks::util::benchmark_invoker invoker{num_push_pop};
-    invoker.invoke(
+    locks::util::benchmark_invoker invoker{
+        num_operations, producers, consumers, item_size};
+    invoker.set_operations(num_operations);
+    invoker.invoke(GET_FUNCTION_PAIR(lock_free_queue),
+        GET_FUNCTION_PAIR(bounded_lock_free_queue),
+#if LOCKS_WITH_HPX
         GET_FUNCTION_PAIR(concurrent_queue<hpx::lcos::local::spinlock>),
+#endif
         GET_FUNCTION_PAIR(concurrent_queue<locks::TAS_lock>),
         GET_FUNCTION_PAIR(concurrent_queue<locks::TAS_BO_lock>),
         GET_FUNCTION_PAIR(concurrent_queue<locks::TTAS_lock>),
@@ -60,25 +542,83 @@ int hpx_main(hpx::program_options::variables_map& vm)
         GET_FUNCTION_PAIR(concurrent_queue<locks::MCS_lock>),
         GET_FUNCTION_PAIR(concurrent_queue<locks::MCS_BO_lock>),
         GET_FUNCTION_PAIR(concurrent_queue<locks::CLH_lock>),
-        GET_FUNCTION_PAIR(concurrent_queue<locks::CLH_BO_lock>)
-    // 
+        GET_FUNCTION_PAIR(concurrent_queue<locks::CLH_BO_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::CLH_RC_BO_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::Ticket_BO_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::Partitioned_ticket_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::Partitioned_ticket_BO_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::Anderson_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::C_TKT_MCS_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::C_BO_MCS_lock>),
+        GET_FUNCTION_PAIR(concurrent_queue<locks::C_MCS_MCS_lock>),
+#if LOCKS_WITH_HPX
+        GET_FUNCTION_PAIR(concurrent_queue<hpx::lcos::local::mutex>),
+#else
+        GET_FUNCTION_PAIR(concurrent_queue<std::mutex>),
+#endif
+        GET_FUNCTION_PAIR(concurrent_queue<locks::Parking_lock>),
+#if LOCKS_WITH_HPX
+        GET_FUNCTION_PAIR(two_lock_queue<hpx::lcos::local::spinlock>),
+#endif
+        GET_FUNCTION_PAIR(two_lock_queue<locks::TAS_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::TAS_BO_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::TTAS_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::TTAS_BO_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::MCS_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::MCS_BO_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::CLH_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::CLH_BO_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::CLH_RC_BO_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::Ticket_BO_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::Partitioned_ticket_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::Partitioned_ticket_BO_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::Anderson_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::C_TKT_MCS_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::C_BO_MCS_lock>),
+        GET_FUNCTION_PAIR(two_lock_queue<locks::C_MCS_MCS_lock>),
+#if LOCKS_WITH_HPX
+        GET_FUNCTION_PAIR(two_lock_queue<hpx::lcos::local::mutex>),
+#else
+        GET_FUNCTION_PAIR(two_lock_queue<std::mutex>),
+#endif
+        GET_FUNCTION_PAIR(two_lock_queue<locks::Parking_lock>),
+        GET_FUNCTION_PAIR(combining_queue<locks::Flat_combining_lock>),
+        GET_FUNCTION_PAIR(combining_queue<Flat_combining_TAS_BO_lock>)
+    //
     );
 
-    return hpx::finalize();    // Handles HPX shutdown
+    return 0;
 }
 
 int main(int argc, char* argv[])
 {
-    hpx::program_options::options_description desc_commandline(
-        "Usage: " HPX_APPLICATION_STRING " [options]");
+    locks::util::program_options::options_description desc_commandline(
+        std::string("Usage: ") + argv[0] + " [options]");
 
-    desc_commandline.add_options()("num-push-pop",
-        hpx::program_options::value<std::uint64_t>()->default_value(10000),
-        "Number of Push-Pop operations");
+    desc_commandline.add_options()("num-operations",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            20000),
+        "Number of pushes and pops");
+    desc_commandline.add_options()("producers",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            1),
+        "Share of pushes, relative to --consumers");
+    desc_commandline.add_options()("consumers",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            1),
+        "Share of pops, relative to --producers");
+    desc_commandline.add_options()("item-size",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            8),
+        "Size of the queue elements in bytes: 8, 64 or 512");
 
-    // Initialize and run HPX
-    hpx::init_params init_args;
-    init_args.desc_cmdline = desc_commandline;
+    desc_commandline.add(locks::util::lock_options());
+    desc_commandline.add(locks::util::benchmark_options());
 
-    return hpx::init(argc, argv, init_args);
+    return locks::util::run_benchmark(
+        argc, argv, desc_commandline, benchmark_main);
 }
@@ -0,0 +1,151 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#include <locks.hpp>
+#include <util/benchmark.hpp>
+
+#if LOCKS_WITH_HPX
+#include <hpx/modules/lcos_local.hpp>
+#include <hpx/modules/synchronization.hpp>
+#endif
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////
+// Exclusive locks have no shared mode, readers take them exclusively.
+template <typename LockType, typename Enable = void>
+struct read_guard : std::lock_guard<LockType>
+{
+    using std::lock_guard<LockType>::lock_guard;
+};
+
+template <typename LockType>
+struct read_guard<LockType,
+    std::void_t<decltype(std::declval<LockType&>().lock_shared())>>
+  : std::shared_lock<LockType>
+{
+    using std::shared_lock<LockType>::shared_lock;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+template <typename LockType>
+struct rw_cases
+{
+    ////////////////////////////////////////////////////////////////////////////
+    // Readers walk the protected data for grain_size, writers update it for
+    // grain_size. Readers holding a shared lock can do so concurrently.
+    void reader(std::uint64_t grain_size)
+    {
+        read_guard<LockType> guard(lock);
+
+        std::uint64_t sum = 0;
+        locks::platform::timer t;
+        while (t.elapsed() * 1e6 < grain_size)
+        {
+            for (std::uint64_t value : data)
+                sum += value;
+        }
+
+        // Keeps the loop alive, a member would be written by concurrent
+        // readers
+        std::uint64_t volatile sink = sum;
+        static_cast<void>(sink);
+    }
+
+    void writer(std::uint64_t grain_size)
+    {
+        std::lock_guard<LockType> guard(lock);
+
+        locks::platform::timer t;
+        while (t.elapsed() * 1e6 < grain_size)
+        {
+            for (std::uint64_t& value : data)
+                ++value;
+        }
+    }
+
+private:
+    std::array<std::uint64_t, 64> data{};
+    LockType lock{};
+};
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+// read_percentage out of every 100 tasks are readers, spread evenly over the
+// iteration space.
+template <typename LockType>
+void read_write(std::uint64_t num_tasks, std::uint64_t grain_size,
+    std::uint64_t read_percentage)
+{
+    rw_cases<LockType> cases;
+
+    locks::util::parallel_for(num_tasks,
+        [&cases, grain_size, read_percentage](std::uint64_t i) {
+            if ((i * 37) % 100 < read_percentage)
+                cases.reader(grain_size);
+            else
+                cases.writer(grain_size);
+        });
+}
+////////////////////////////////////////////////////////////////////////////////
+
+int benchmark_main(locks::util::program_options::variables_map& vm)
+{
+    std::uint64_t num_tasks = vm["num-tasks"].as<std::uint64_t>();
+    std::uint64_t grain_size = vm["grain-size"].as<std::uint64_t>();
+    std::uint64_t read_percentage = vm["read-percentage"].as<std::uint64_t>();
+
+    if (!locks::util::configure_locks(vm))
+        return 1;
+    locks::util::configure_benchmark(vm);
+
+    locks::util::benchmark_invoker invoker{
+        num_tasks, grain_size, read_percentage};
+    invoker.invoke(
+#if LOCKS_WITH_HPX
+        GET_FUNCTION_PAIR(read_write<hpx::lcos::local::spinlock>),
+#else
+        GET_FUNCTION_PAIR(read_write<std::shared_mutex>),
+#endif
+        GET_FUNCTION_PAIR(read_write<locks::TAS_BO_lock>),
+        GET_FUNCTION_PAIR(read_write<locks::TTAS_BO_lock>),
+        GET_FUNCTION_PAIR(read_write<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(read_write<locks::MCS_lock>),
+        GET_FUNCTION_PAIR(read_write<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(read_write<locks::Phase_fair_RW_lock>),
+        GET_FUNCTION_PAIR(read_write<locks::MCS_RW_lock>)
+        //
+    );
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    locks::util::program_options::options_description desc_commandline(
+        std::string("Usage: ") + argv[0] + " [options]");
+
+    desc_commandline.add_options()("num-tasks",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            10000),
+        "Number of tasks to launch");
+    desc_commandline.add_options()("grain-size",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            100),
+        "Grain size of each task");
+    desc_commandline.add_options()("read-percentage",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            90),
+        "Percentage of tasks that only read the protected data");
+
+    desc_commandline.add(locks::util::lock_options());
+    desc_commandline.add(locks::util::benchmark_options());
+
+    return locks::util::run_benchmark(
+        argc, argv, desc_commandline, benchmark_main);
+}
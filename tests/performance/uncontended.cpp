@@ -0,0 +1,375 @@
+// Copyright (c) 2021 Nikunj Gupta
+
+#include <locks.hpp>
+#include <util/benchmark.hpp>
+#include <util/topology.hpp>
+
+#if LOCKS_WITH_HPX
+#include <hpx/modules/synchronization.hpp>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Time stamp counter, it ticks at a constant rate close to the nominal clock
+// of the CPU. The fences keep the measured code from moving across the
+// reads. There is no cycle count on other architectures.
+#if defined(__x86_64__) || defined(__i386__)
+constexpr bool has_tsc = true;
+
+inline std::uint64_t tsc_begin()
+{
+    _mm_lfence();
+    std::uint64_t const tsc = __rdtsc();
+    _mm_lfence();
+    return tsc;
+}
+
+inline std::uint64_t tsc_end()
+{
+    unsigned int aux;
+    std::uint64_t const tsc = __rdtscp(&aux);
+    _mm_lfence();
+    return tsc;
+}
+#else
+constexpr bool has_tsc = false;
+
+inline std::uint64_t tsc_begin()
+{
+    return 0;
+}
+
+inline std::uint64_t tsc_end()
+{
+    return 0;
+}
+#endif
+
+// Keeps the compiler from merging or dropping loop iterations
+inline void compiler_barrier()
+{
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+struct cost
+{
+    double ns{0.0};
+    double cycles{0.0};
+};
+
+// Median cost of one call of f over samples batches of batch calls
+template <typename F>
+cost measure(std::uint64_t batch, std::uint64_t samples, F&& f)
+{
+    std::vector<double> ns;
+    std::vector<double> cycles;
+    for (std::uint64_t s = 0; s != samples; ++s)
+    {
+        std::uint64_t const t0 = locks::platform::now();
+        std::uint64_t const c0 = tsc_begin();
+        for (std::uint64_t i = 0; i != batch; ++i)
+            f();
+        std::uint64_t const c1 = tsc_end();
+        std::uint64_t const t1 = locks::platform::now();
+
+        ns.push_back(static_cast<double>(t1 - t0) / batch);
+        cycles.push_back(static_cast<double>(c1 - c0) / batch);
+    }
+
+    auto median = [](std::vector<double>& v) {
+        std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+        return v[v.size() / 2];
+    };
+    return cost{median(ns), median(cycles)};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Two CPUs the ping-pong threads are pinned to, see cpu_pairs()
+struct cpu_pair
+{
+    std::string name;
+    bool found{false};
+    std::size_t first{0};
+    std::size_t second{0};
+};
+
+// The first CPU threads can be placed on, paired with itself, an SMT
+// sibling, another core of its socket and a core of another socket
+std::vector<cpu_pair> cpu_pairs()
+{
+    locks::util::cpu_topology const& topology =
+        locks::util::cpu_topology::get();
+
+    std::vector<std::size_t> usable;
+    for (std::size_t cpu : topology.cpus())
+    {
+        if (locks::platform::can_run_on_cpu(cpu))
+            usable.push_back(cpu);
+    }
+
+    std::vector<cpu_pair> pairs{{"same CPU"}, {"SMT siblings"},
+        {"same socket"}, {"other socket"}};
+    if (usable.empty())
+        return pairs;
+
+    std::size_t const first = usable.front();
+    std::size_t const package = topology.package_of(first);
+    std::size_t const core = topology.core_of(first);
+
+    pairs[0] = cpu_pair{pairs[0].name, true, first, first};
+    for (std::size_t cpu : usable)
+    {
+        cpu_pair* pair = nullptr;
+        if (topology.package_of(cpu) != package)
+            pair = &pairs[3];
+        else if (topology.core_of(cpu) != core)
+            pair = &pairs[2];
+        else if (cpu != first)
+            pair = &pairs[1];
+
+        if (pair != nullptr && !pair->found)
+            *pair = cpu_pair{pair->name, true, first, cpu};
+    }
+    return pairs;
+}
+
+// Both threads take turns: wait for their turn, run an empty critical
+// section and pass the turn on. The lock is free whenever a thread tries
+// to acquire it, but it was last held on the other CPU, so every
+// acquisition pulls the lock (and the turn) over from there. Returns the
+// nanoseconds per handoff.
+template <typename LockType>
+double ping_pong(cpu_pair const& cpus, std::uint64_t rounds)
+{
+    LockType lock;
+    std::uint64_t counter = 0;
+    alignas(locks::policy::cache_line_size) std::atomic<std::uint64_t> turn{
+        0};
+
+    std::uint64_t start = 0;
+    std::uint64_t stop = 0;
+    bool const same_cpu = cpus.first == cpus.second;
+
+    auto side = [&](std::uint64_t me) {
+        for (std::uint64_t r = me; r < 2 * rounds; r += 2)
+        {
+            while (turn.load(std::memory_order_acquire) != r)
+            {
+                // Threads sharing a CPU only take turns when they yield
+                if (same_cpu)
+                    locks::platform::yield();
+                else
+                    locks::platform::pause();
+            }
+
+            if (r == 0)
+                start = locks::platform::now();
+
+            locks::util::run_locked(lock, [&counter] { ++counter; });
+
+            if (r + 1 == 2 * rounds)
+                stop = locks::platform::now();
+
+            turn.store(r + 1, std::memory_order_release);
+        }
+    };
+
+    auto first = locks::platform::run_on_cpu(cpus.first, [&] { side(0); });
+    auto second =
+        locks::platform::run_on_cpu(cpus.second, [&] { side(1); });
+    first.get();
+    second.get();
+
+    return static_cast<double>(stop - start) / (2 * rounds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+struct parameters
+{
+    std::uint64_t batch;
+    std::uint64_t samples;
+    std::uint64_t rounds;
+
+    // Cost of an empty batch iteration, subtracted from the lock costs
+    cost overhead;
+    std::vector<cpu_pair> pairs;
+};
+
+struct lock_result
+{
+    cost uncontended;
+
+    // Per pair of parameters::pairs, negative if not measured
+    std::vector<double> handoff;
+};
+
+template <typename LockType>
+lock_result uncontended(parameters const& params)
+{
+    lock_result result;
+
+    {
+        LockType lock;
+        auto lock_unlock = [&lock] {
+            locks::util::run_locked(lock, compiler_barrier);
+        };
+
+        // Warm up the caches, node caches and the allocator
+        measure(params.batch, 1, lock_unlock);
+
+        cost const c = measure(params.batch, params.samples, lock_unlock);
+        result.uncontended.ns = std::max(c.ns - params.overhead.ns, 0.0);
+        result.uncontended.cycles =
+            std::max(c.cycles - params.overhead.cycles, 0.0);
+    }
+
+    // Combining and delegation locks may run the critical section on a
+    // third thread, which has no place in a handoff between two CPUs
+    constexpr bool delegates =
+        locks::util::has_execute<LockType, void (&)()>::value;
+
+    for (cpu_pair const& pair : params.pairs)
+    {
+        if (!pair.found || delegates)
+            result.handoff.push_back(-1.0);
+        else
+            result.handoff.push_back(ping_pong<LockType>(pair, params.rounds));
+    }
+
+    return result;
+}
+
+template <typename... Rows>
+void run_rows(parameters const& params, Rows const&... rows)
+{
+    auto column = [](double value) {
+        std::ostringstream os;
+        if (value < 0.0)
+            os << '-';
+        else
+            os << std::fixed << std::setprecision(1) << value;
+        return os.str();
+    };
+
+    std::cout << std::left << std::setw(50) << "Name: " << std::setw(10)
+              << "ns" << std::setw(10) << "cycles";
+    for (cpu_pair const& pair : params.pairs)
+        std::cout << std::setw(14) << pair.name;
+    std::cout << '\n';
+
+    auto run_row = [&](auto const& row) {
+        lock_result const result = row.first(params);
+
+        std::cout << std::left << std::setw(50) << row.second << std::setw(10)
+                  << column(result.uncontended.ns) << std::setw(10)
+                  << column(has_tsc ? result.uncontended.cycles : -1.0);
+        for (double handoff : result.handoff)
+            std::cout << std::setw(14) << column(handoff);
+        std::cout << '\n';
+    };
+    (run_row(rows), ...);
+}
+
+int benchmark_main(locks::util::program_options::variables_map& vm)
+{
+    if (!locks::util::configure_locks(vm))
+        return 1;
+
+    parameters params;
+    params.batch = std::max<std::uint64_t>(vm["batch"].as<std::uint64_t>(), 1);
+    params.samples =
+        std::max<std::uint64_t>(vm["samples"].as<std::uint64_t>(), 1);
+    params.rounds =
+        std::max<std::uint64_t>(vm["rounds"].as<std::uint64_t>(), 1);
+    params.overhead = measure(params.batch, params.samples, compiler_barrier);
+    params.pairs = cpu_pairs();
+
+    std::cout << "Uncontended lock and unlock on one thread, loop overhead of "
+              << params.overhead.ns << " ns subtracted\n"
+              << "Handoff latency in ns between two threads pinned to\n";
+    for (cpu_pair const& pair : params.pairs)
+    {
+        std::cout << "    " << pair.name << ": ";
+        if (pair.found)
+            std::cout << "CPU " << pair.first << " and " << pair.second;
+        else
+            std::cout << "none available";
+        std::cout << '\n';
+    }
+    std::cout << '\n';
+
+    run_rows(params,
+#if LOCKS_WITH_HPX
+        GET_FUNCTION_PAIR(uncontended<hpx::lcos::local::spinlock>),
+        GET_FUNCTION_PAIR(uncontended<hpx::lcos::local::mutex>),
+#else
+        GET_FUNCTION_PAIR(uncontended<std::mutex>),
+#endif
+        GET_FUNCTION_PAIR(uncontended<locks::TAS_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::TAS_BO_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::TTAS_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::TTAS_BO_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::MCS_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::MCS_BO_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::CLH_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::CLH_BO_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::CLH_RC_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::CLH_RC_BO_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Ticket_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Ticket_BO_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Partitioned_ticket_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Partitioned_ticket_BO_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Anderson_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::C_TKT_MCS_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::C_BO_MCS_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::C_MCS_MCS_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::MCS_RW_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Phase_fair_RW_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Parking_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Flat_combining_lock>),
+        GET_FUNCTION_PAIR(uncontended<locks::Delegation_lock>)
+        //
+    );
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    locks::util::program_options::options_description desc_commandline(
+        std::string("Usage: ") + argv[0] + " [options]");
+
+    desc_commandline.add_options()("batch",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            1000),
+        "Number of lock and unlock pairs timed together");
+    desc_commandline.add_options()("samples",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            101),
+        "Number of timed batches, the median is reported");
+    desc_commandline.add_options()("rounds",
+        locks::util::program_options::value<std::uint64_t>()->default_value(
+            10000),
+        "Number of round trips of every ping-pong test");
+
+    desc_commandline.add(locks::util::lock_options());
+
+    return locks::util::run_benchmark(
+        argc, argv, desc_commandline, benchmark_main);
+}